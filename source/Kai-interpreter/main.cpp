@@ -32,6 +32,12 @@
 #include <Kai/Symbol.hpp>
 #include <Kai/String.hpp>
 #include <Kai/System.hpp>
+#include <Kai/Bytecode/Compiler.hpp>
+#include <Kai/Tiering.hpp>
+
+#ifdef KAI_JIT
+#include <LLVM/src/Compiler.hpp>
+#endif
 
 namespace {
 	
@@ -112,6 +118,13 @@ namespace {
 		Array::import(frame);
 		System::import(frame);
 		
+		Bytecode::Compiler::import(frame);
+		Tiering::import(frame);
+		
+#ifdef KAI_JIT
+		JIT::Compiler::import(frame);
+#endif
+		
 		// Console manipulation:
 		Terminal::import(frame);
 		
@@ -9,659 +9,701 @@
 
 #include "Compiler.hpp"
 
-#include "Frame.hpp"
-#include "Function.hpp"
+#include <Kai/Frame.hpp>
+#include <Kai/Cell.hpp>
+#include <Kai/Symbol.hpp>
+#include <Kai/String.hpp>
+#include <Kai/Number.hpp>
+#include <Kai/Lambda.hpp>
+#include <Kai/Logic.hpp>
+#include <Kai/Table.hpp>
+#include <Kai/Function.hpp>
+#include <Kai/Exception.hpp>
 
-#include <string>
-#include <memory>
-#include <limits>
-
-// llvm::InitializeNativeTarget()
-#include <llvm/Target/TargetSelect.h>
-#include <llvm/Bitcode/ReaderWriter.h>
-#include <llvm/Module.h>
-#include <llvm/ExecutionEngine/ExecutionEngine.h>
-#include <llvm/Support/MemoryBuffer.h>
-#include <llvm/ExecutionEngine/JIT.h>
-#include <llvm/Assembly/PrintModulePass.h>
-
-#include <llvm/DerivedTypes.h>
-#include <llvm/Analysis/Verifier.h>
-#include <llvm/Support/IRBuilder.h>
-#include <llvm/Support/raw_os_ostream.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/Support/raw_ostream.h>
 
 namespace Kai {
-	
-	Compiler::Compiler ()
-	{
-		using std::auto_ptr;
+	namespace JIT {
 		
-		static bool s_initialized = false;		
+		const char * const Type::NAME = "CompiledType";
 		
-		if (!s_initialized) {
-			llvm::InitializeNativeTarget();
-			//llvm::llv_start_multithreaded();
-			
-			s_initialized = true;
+		Type::Type(unsigned bits) : _bits(bits) {
 		}
 		
-		llvm::LLVMContext & context = llvm::getGlobalContext();
-		
-		StringT error;
-		auto_ptr<llvm::MemoryBuffer> buffer(llvm::MemoryBuffer::getFile("machine.o"));
-		
-		if (!buffer.get()) {
-			std::cerr << "Could not load machine bitcode!" << std::endl;
-			_module = new llvm::Module("machine", context);
-		} else {
-			_module = llvm::ParseBitcodeFile(buffer.get(), context, &error);
-			buffer.release();
-			
-			// Extract some useful type information.
-			_frameType = _module->getFunction("_frameType")->getReturnType();
-			_valueType = _module->getFunction("_valueType")->getReturnType();
+		Type::~Type() {
 		}
 		
-		if (!_module) {
-			std::cerr << "Could not create machine module!" << std::endl;
-			std::cerr << "*** " << error << std::endl;
-			
-			return;
+		Ref<Symbol> Type::identity(Frame * frame) const {
+			return frame->sym(NAME);
 		}
 		
-		_engine = llvm::ExecutionEngine::createJIT(_module, &error);
-		
-		if (!_engine) {
-			std::cerr << "Could not create execution engine!" << std::endl;
-			std::cerr << "*** " << error << std::endl;
+		ComparisonResult Type::compare(const Object * other) const {
+			return derived_compare(this, other);
 		}
 		
-		_builder = new llvm::IRBuilder<>(llvm::getGlobalContext());
-		
-		// Create the function optimiser, optimisation level 3
-		_functionOptimizer = new llvm::FunctionPassManager(_module);
-		llvm::createStandardFunctionPasses(_functionOptimizer, 3);
-		_functionOptimizer->doInitialization();
-		
-		// Create the module optimiser, optimisation level 3
-		_moduleOptimizer = new llvm::PassManager;
-		llvm::createStandardModulePasses(_moduleOptimizer,
-			1, false, true, true, true, true, NULL
-		);
-	}
-		
-	Compiler::~Compiler () {
-		std::cout << "Freeing execution engine" << std::endl;
-		
-		if (_module)
-			delete _module;
-		
-		if (_engine)
-			delete _engine;
-		
-		if (_builder)
-			delete _builder;
-	}
-	
-	// Returns a compiled function corresponding to the given arguments.
-	Object * Compiler::evaluate (Frame * frame) {
-		Compiler * c = frame->lookupAs<Compiler>(frame->sym("compiler"));
-
-		Symbol * name;	
-		CompiledType * signature;
-		Cell * argumentNames;
-		Object * body;
-		
-		frame->extract()(name)(signature)[argumentNames](body);
-		
-		const llvm::FunctionType * funcType = dynamic_cast<const llvm::FunctionType*>(signature->value());
-		
-		if (!funcType) {
-			throw Exception("Invalid function signature!", signature, frame);
+		ComparisonResult Type::compare(const Type * other) const {
+			if (_bits < other->_bits) {
+				return ASCENDING;
+			} else if (_bits > other->_bits) {
+				return DESCENDING;
+			} else {
+				return EQUAL;
+			}
 		}
 		
-		llvm::Function * func = llvm::Function::Create(
-			funcType,
-			llvm::Function::ExternalLinkage,
-			name->value(),
-			c->module()
-		);
-		
-		//func->setCallingConv(llvm::CallingConv::Fast);
-		//func->setVisibility(llvm::GlobalObject::HiddenVisibility);
-		
-		Table * arguments = new Table;
-
-		// For recursion
-		arguments->update(name, new CompiledFunction(func));
+		void Type::to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
+			buffer << "(int " << _bits << ")";
+		}
 		
-		for (llvm::Function::arg_iterator arg = func->arg_begin(); arg != func->arg_end(); arg++) {
-			Symbol * name = argumentNames->head().as<Symbol>();
+		Ref<Object> Type::integer(Frame * frame) {
+			Integral * bits = NULL;
 			
-			arg->setName(name->value());
+			frame->extract()(bits, "bits");
 			
-			arguments->update(name, new CompiledValue(&*arg));
+			// Values are computed using 64 bits, so wider types can't be represented:
+			Math::Integer value = bits->to_integer();
+			Math::IntermediateT width = value.to_intermediate();
+			
+			if (width < 1 || width > 64 || value.size() > Math::INTERMEDIATE_DIGITS) {
+				throw Exception("Invalid Integer Width", frame);
+			}
 			
-			argumentNames = argumentNames->tail().as<Cell>();
+			return new(frame) Type(width);
 		}
 		
-		llvm::BasicBlock *entryBlock = llvm::BasicBlock::Create(llvm::getGlobalContext(), "entry", func);
-		c->builder()->SetInsertPoint(entryBlock);
-		
-		Frame * next = new Frame(arguments, frame);
-		//std::cout << "Compiling: " << Object::to_string(body) << std::endl;
-		llvm::Object * result = body->compile(next);
-		
-		// Automatically return the last variable
-		//if (!c->builder()->GetInsertBlock()->getTerminator() && result) {
-		//	c->builder()->CreateRet(result);
-		//}
+// MARK: -
 		
-		// Check the function is okay
-		llvm::verifyFunction(*func);
+		const char * const Signature::NAME = "CompiledSignature";
 		
-		return new CompiledFunction(func);
-	}
-
-	Object * Compiler::lookup (Symbol * identifier) {
-		StringT functionName = identifier->value();
+		Signature::Signature(Type * result, const ArgumentsT & arguments) : _result(result), _arguments(arguments) {
+		}
 		
-		llvm::Function* code = _engine->FindFunctionNamed(functionName.c_str());
+		Signature::~Signature() {
+		}
 		
-		if (!code) {
-			return NULL;
+		Ref<Symbol> Signature::identity(Frame * frame) const {
+			return frame->sym(NAME);
 		}
 		
-		return new CompiledFunction(code);
-	}
+		void Signature::mark(Memory::Traversal * traversal) const {
+			traversal->traverse(_result);
 			
-	Object * Compiler::prototype () {
-		return Object::prototype();
-	}
-	
-	llvm::ExecutionEngine * Compiler::engine () {
-		return _engine;
-	}
-	
-	llvm::Module * Compiler::module () {
-		return _module;
-	}
-	
-	llvm::IRBuilder<> * Compiler::builder () {
-		return _builder;
-	}
-	
-	llvm::FunctionPassManager * Compiler::functionOptimizer () {
-		return _functionOptimizer;
-	}
-	
-	llvm::PassManager * Compiler::moduleOptimizer () {
-		return _moduleOptimizer;
-	}
-	
-	const llvm::Type * Compiler::framePointerType () {
-		return _frameType;
-	}
-	
-	const llvm::Type * Compiler::valuePointerType () {
-		return _valueType;
-	}
-	
-	void Compiler::to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
-		buffer << "(compiler)";
-	}
-	
-	DynamicFunction * Compiler::resolve (CompiledFunction * compiledFunction) {
-		void * p = _engine->getPointerToFunction(compiledFunction->_code);
-		
-		if (!p) {
-			return NULL;
+			for (ArgumentsT::const_iterator argument = _arguments.begin(); argument != _arguments.end(); ++argument) {
+				traversal->traverse(*argument);
+			}
 		}
 		
-		EvaluateFunctionT function = reinterpret_cast<EvaluateFunctionT>(p);
-		
-		return new DynamicFunction(function);
-	}
-	
-	void Compiler::import (Table * context) {
-		Compiler * c = new Compiler;
-		
-		context->update(frame->sym("compiler"), c);
-		
-		if (c->valuePointerType())
-			context->update(frame->sym("Value"), new CompiledType(c->valuePointerType()));
+		void Signature::to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
+			buffer << "(function ";
+			_result->to_code(frame, buffer, marks, indentation);
+			
+			for (ArgumentsT::const_iterator argument = _arguments.begin(); argument != _arguments.end(); ++argument) {
+				buffer << " ";
+				(*argument)->to_code(frame, buffer, marks, indentation);
+			}
+			
+			buffer << ")";
+		}
 		
-		if (c->framePointerType())
-			context->update(frame->sym("Frame"), new CompiledType(c->framePointerType()));
+		Ref<Object> Signature::function(Frame * frame) {
+			Type * result = NULL;
+			ArgumentsT arguments;
+			
+			for (Cell * types = frame->unwrap(); types != NULL; types = types->tail().as<Cell>()) {
+				Type * type = types->head().as<Type>();
+				
+				if (!type) {
+					throw ArgumentError("type", Type::NAME, types->head(), frame);
+				}
+				
+				if (!result)
+					result = type;
+				else
+					arguments.push_back(type);
+			}
+			
+			if (!result) {
+				throw Exception("Invalid Result Type", frame);
+			}
+			
+			return new(frame) Signature(result, arguments);
+		}
 		
-		CompiledObject::import(context);
-	}
-
 // MARK: -
-	
-	CompiledFunction::CompiledFunction (llvm::Function * code) : _code(code) {
 		
-	}
-	
-	CompiledFunction::~CompiledFunction () {
-	
-	}
-	
-	void CompiledFunction::to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
-		buffer << "(compiled-function ";
-		buffer << _code->getNameStr();
-		buffer << ")";
-	}
-
-	Object * CompiledFunction::prototype () {
-		return globalPrototype();
-	}
-	
-	Object * CompiledFunction::evaluate (Frame * frame) {
-		Compiler * compiler = dynamic_cast<Kai::Compiler *>(frame->lookup(frame->sym("compiler")));
-		typedef int (FuncT)(int, int);
-		FuncT * f = (FuncT*)compiler->engine()->getPointerToFunction(_code);
+		const char * const Function::NAME = "CompiledFunction";
 		
-		Integer * f1, * f2;
-		frame->extract()[f1][f2];
+		Function::Function(const std::string & name, Signature * signature, EntryT entry, const StringT & code) : _name(name), _signature(signature), _entry(entry), _code(code) {
+		}
 		
-		int r = f(f1->value(), f2->value());
+		Function::~Function() {
+		}
 		
-		return new Integer(r);
-	}
-	
-	llvm::Object * CompiledFunction::compile (Frame * frame)
-	{
-		Compiler * compiler = dynamic_cast<Kai::Compiler *>(frame->lookup(frame->sym("compiler")));
-
-		std::vector<llvm::Value*> operands;
-		Cell * arguments = frame->unwrap();
+		Ref<Symbol> Function::identity(Frame * frame) const {
+			return frame->sym(NAME);
+		}
 		
-		//std::cerr << "Compiling function " << Object::to_string(arguments) << std::endl;
+		void Function::mark(Memory::Traversal * traversal) const {
+			traversal->traverse(_signature);
+		}
 		
-		while (arguments != NULL) {
-			llvm::Object * operand = arguments->head()->compile(frame);
-			assert(operand != NULL);
+		int Function::apply(Frame * frame, Object ** arguments, std::size_t count, Ref<Object> & result) {
+			const Signature::ArgumentsT & types = _signature->arguments();
+			
+			if (count != types.size())
+				return -1;
+			
+			// Most functions have only a few arguments, which can be converted without any allocation:
+			uint64_t inline_values[8];
+			std::vector<uint64_t> allocated_values;
+			uint64_t * values = inline_values;
+			
+			if (count > 8) {
+				allocated_values.resize(count);
+				values = allocated_values.data();
+			}
+			
+			for (std::size_t i = 0; i < count; i += 1) {
+				Integer * integer = ptr(arguments[i]).as<Integer>();
+				
+				if (!integer)
+					return -1;
+				
+				// The bit size of zero is undefined, but it always fits:
+				if (!integer->value().is_zero() && integer->value().bit_size() > types[i]->bits())
+					return -1;
+				
+				values[i] = integer->value().to_intermediate();
+			}
 			
-			operands.push_back(operand);
+			uint32_t fault = 0;
+			uint64_t value = _entry(values, &fault);
 			
-			arguments = arguments->tail().as<Cell>();
+			if (!fault)
+				result = Integer::create(frame, value);
+			
+			return fault;
 		}
 		
-		llvm::CallInst * call = compiler->builder()->CreateCall(_code, operands.begin(), operands.end());
-		//call->setCallingConv(llvm::CallingConv::Fast);
-		
-		return call;
-	}
-	
-	llvm::Object * CompiledFunction::compiledValue (Frame * frame)
-	{
-		return _code;
-	}
-	
-	Object * CompiledFunction::code(Frame * frame) {
-		CompiledFunction * function = NULL;
-		frame->extract()(function);
-		
-		StringStreamT buffer;
-		llvm::raw_os_ostream llvmBuffer(buffer);
-		function->compiledValue(frame)->print(llvmBuffer);
-		llvmBuffer.flush();
-		
-		return new String(buffer.str());
-	}
-	
-	Object * CompiledFunction::optimize (Frame * frame) {
-		Compiler * compiler = dynamic_cast<Kai::Compiler *>(frame->lookup(frame->sym("compiler")));
-		CompiledFunction * function = NULL;
-		
-		frame->extract()(function);
-		
-		compiler->functionOptimizer()->run(*(function->_code));
-		compiler->moduleOptimizer()->run(*(compiler->module()));
-		
-		return function;
-	}
-	
-	Object * CompiledFunction::resolve (Frame * frame) {
-		CompiledFunction * self = NULL;
-		Compiler * compiler = dynamic_cast<Kai::Compiler *>(frame->lookup(frame->sym("compiler")));
+		bool Function::call(Frame * frame, Object ** arguments, std::size_t count, Ref<Object> & result) {
+			return apply(frame, arguments, count, result) == 0;
+		}
 		
-		frame->extract()(self);
+		Ref<Object> Function::evaluate(Frame * frame) {
+			const Signature::ArgumentsT & types = _signature->arguments();
+			std::vector<Object *> arguments;
+			
+			for (Cell * cell = frame->unwrap(); cell != NULL; cell = cell->tail().as<Cell>()) {
+				Integer * integer = cell->head().as<Integer>();
+				
+				if (!integer) {
+					throw ArgumentError("argument", Integer::NAME, cell->head(), frame);
+				}
+				
+				if (arguments.size() == types.size()) {
+					throw Exception("Compiled Function Arity Mismatch", this, frame);
+				}
+				
+				arguments.push_back(integer);
+			}
+			
+			if (arguments.size() != types.size()) {
+				throw Exception("Compiled Function Arity Mismatch", this, frame);
+			}
+			
+			Ref<Object> result;
+			int fault = apply(frame, arguments.data(), arguments.size(), result);
+			
+			if (fault == -1) {
+				throw Exception("Integer Out Of Range", this, frame);
+			} else if (fault & DIVISION_BY_ZERO) {
+				throw Exception("Division By Zero", this, frame);
+			} else if (fault & INTEGER_OVERFLOW) {
+				throw Exception("Integer Overflow", this, frame);
+			}
+			
+			return result;
+		}
 		
-		if (!compiler) {
-			throw Exception("Could not find compiler!", frame);
+		void Function::to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
+			buffer << "(compiled-function " << _name << " ";
+			_signature->to_code(frame, buffer, marks, indentation);
+			buffer << ")";
 		}
 		
-		return compiler->resolve(self);
-	}
-	
-	void CompiledFunction::import (Table * context) {
-		context->update(frame->sym("CompiledFunction"), globalPrototype());
-	}
-	
-	Object * CompiledFunction::globalPrototype () {
-		static Ref<Table> g_prototype;
+		Ref<Object> Function::code(Frame * frame) {
+			Function * function;
+			
+			frame->extract()(function, "self");
+			
+			return new(frame) String(function->_code);
+		}
 		
-		if (!g_prototype) {
-			g_prototype = new Table;
+		void Function::import(Frame * frame) {
+			Table * prototype = new(frame) Table;
 			
-			g_prototype->update(frame->sym("code"), KAI_BUILTIN_FUNCTION(CompiledFunction::code));
-			g_prototype->update(frame->sym("resolve"), KAI_BUILTIN_FUNCTION(CompiledFunction::resolve));
-			g_prototype->update(frame->sym("optimize"), KAI_BUILTIN_FUNCTION(CompiledFunction::optimize));
+			prototype->update(frame->sym("code"), KAI_BUILTIN_FUNCTION(Function::code));
+			
+			frame->update(frame->sym(NAME), prototype);
 		}
 		
-		return g_prototype;
-	}
-
 // MARK: -
-	
-	CompiledType::CompiledType (const llvm::Type * ty) : _type(ty) {
-	
-	}
-	
-	CompiledType::~CompiledType () {
-	
-	}
-	
-	class IntegerEquality : public Value {
-		public:
-			virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
-				buffer << "(builtin-integer-equality)";
+		
+		/// A value produced by generated code. Comparisons are kept as booleans until they are used as integers.
+		struct Value {
+			llvm::Value * value;
+			bool boolean;
+		};
+		
+		/// Generates a module containing the native function, along with an entry point which takes its arguments from an array.
+		class Generator {
+		protected:
+			Frame * _frame;
+			
+			Symbol * _name;
+			Lambda * _lambda;
+			Signature * _signature;
+			
+			std::string _symbol;
+			
+			llvm::LLVMContext & _context;
+			llvm::Module & _module;
+			llvm::IRBuilder<> _builder;
+			
+			llvm::Function * _function;
+			llvm::Value * _fault;
+			
+			bool _exact;
+			
+			typedef std::vector<std::pair<StringT, llvm::Value *>> ArgumentsT;
+			ArgumentsT _arguments;
+			
+			llvm::Type * word() { return _builder.getInt64Ty(); }
+			
+			llvm::Type * type(Type * type) { return _builder.getIntNTy(type->bits()); }
+			
+			llvm::FunctionType * function_type(Signature * signature) {
+				std::vector<llvm::Type *> arguments;
+				
+				for (Type * argument : signature->arguments()) {
+					arguments.push_back(type(argument));
+				}
+				
+				// Every function can record a fault:
+				arguments.push_back(llvm::PointerType::getUnqual(_builder.getInt32Ty()));
+				
+				return llvm::FunctionType::get(type(signature->result()), arguments, false);
 			}
 			
-			virtual Object * evaluate (Frame * frame) {
-				return new CompiledValue(this->compile(frame));
+			llvm::Value * to_word(const Value & value) {
+				// The interpreter would produce a boolean rather than an integer:
+				if (value.boolean && _exact)
+					unsupported("Unsupported Boolean", NULL);
+				
+				if (value.boolean)
+					return _builder.CreateZExt(value.value, word());
+				else
+					return value.value;
 			}
 			
-			virtual llvm::Object * compile (Frame * frame) {
-				Compiler * c = frame->lookupAs<Compiler>(frame->sym("compiler"));
+			Value integer(llvm::Value * value) {
+				return Value{value, false};
+			}
+			
+			Value unsupported(const char * what, Object * expression) {
+				throw Exception(what, expression, _frame);
+			}
+			
+			/// The value of something which evaluates to nil in Kai, which exact code can't represent.
+			Value nothing(Object * expression) {
+				if (_exact)
+					return unsupported("Unsupported Nil", expression);
 				
-				Object * lhs, * rhs;
-				frame->extract()(lhs)(rhs);
-
-				llvm::Object * result = c->builder()->CreateICmpEQ(lhs->compile(frame), rhs->compile(frame));
+				return integer(_builder.getInt64(0));
+			}
+			
+			/// In a lambda, a special form is only recognised if its name still refers to the builtin.
+			bool is_form(Symbol * name, const char * form, Object * builtin) {
+				if (name->value() != form)
+					return false;
 				
-				return result;
+				return !_lambda || _frame->lookup(name).get() == builtin;
 			}
-	};
-	
-	class IntegerModulus : public Value {
-		public:
-			virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) {
-				buffer << "(builtin-integer-modulus)";
+			
+			Value generate(Object * expression) {
+				if (Integer * literal = ptr(expression).as<Integer>()) {
+					if (literal->value().size() > Math::INTERMEDIATE_DIGITS) {
+						return unsupported("Integer Out Of Range", literal);
+					}
+					
+					return integer(_builder.getInt64(literal->value().to_intermediate()));
+				}
+				
+				if (Symbol * name = ptr(expression).as<Symbol>()) {
+					for (ArgumentsT::iterator argument = _arguments.begin(); argument != _arguments.end(); ++argument) {
+						if (argument->first == name->value())
+							return integer(argument->second);
+					}
+					
+					return unsupported("Unsupported Symbol", name);
+				}
+				
+				if (Cell * message = ptr(expression).as<Cell>()) {
+					return generate_message(message);
+				}
+				
+				return unsupported("Unsupported Expression", expression);
 			}
 			
-			virtual Object * evaluate (Frame * frame) {
-				return new CompiledValue(this->compile(frame));
+			Value generate_message(Cell * message) {
+				Symbol * name = message->head().as<Symbol>();
+				Cell * operands = message->tail().as<Cell>();
+				
+				if (!name) {
+					return unsupported("Unsupported Function", message->head());
+				}
+				
+				if (is_form(name, "block", KAI_BUILTIN_FUNCTION(Logic::block)))
+					return generate_block(operands);
+				
+				if (is_form(name, "if", KAI_BUILTIN_FUNCTION(Logic::if_)))
+					return generate_if(operands);
+				
+				if (is_form(name, "return", KAI_BUILTIN_FUNCTION(Logic::return_)))
+					return generate_return(operands);
+				
+				if (is_form(name, "value", KAI_BUILTIN_FUNCTION(Object::value)))
+					return generate(operands ? operands->head().get() : NULL);
+				
+				if (is_form(name, "call", KAI_BUILTIN_FUNCTION(Object::call)))
+					return generate_operator(message);
+				
+				if ((_name && name->value() == _name->value()) || (_lambda && _frame->lookup(name).get() == _lambda))
+					return generate_call(_function, _signature, operands, message);
+				
+				if (Function * function = _frame->lookup(name).as<Function>()) {
+					// Compiled functions are linked by name:
+					llvm::Function * callee = _module.getFunction(function->name());
+					
+					if (!callee)
+						callee = llvm::Function::Create(function_type(function->signature()), llvm::Function::ExternalLinkage, function->name(), _module);
+					
+					return generate_call(callee, function->signature(), operands, message);
+				}
+				
+				return unsupported("Unsupported Function", name);
 			}
 			
-			virtual llvm::Object * compile (Frame * frame) {
-				// Find the current compiler.
-				Compiler * c = frame->lookupAs<Compiler>(frame->sym("compiler"));
+			Value generate_block(Cell * operands) {
+				if (!operands)
+					return nothing(operands);
 				
-				// Extract the arguments to the operator.
-				Object * lhs, * rhs;
-				frame->extract()(lhs)(rhs);
+				Value result = integer(_builder.getInt64(0));
 				
-				// Return the LLVM remainder instruction with the two arguments.
-				llvm::Object * result = c->builder()->CreateURem(lhs->compile(frame), rhs->compile(frame));
+				for (; operands != NULL; operands = operands->tail().as<Cell>()) {
+					result = generate(operands->head());
+				}
 				
 				return result;
 			}
-	};
-	
-	Object * CompiledType::globalIntegerPrototype () {
-		static Ref<Table> g_prototype;
-		
-		if (!g_prototype) {
-			g_prototype = new Table;
-			g_prototype->set_prototype(Object::globalPrototype());
 			
-			g_prototype->update(frame->sym("=="), new IntegerEquality);
-			g_prototype->update(frame->sym("%"), new IntegerModulus);
-		}
-		
-		return g_prototype;
-	}
-	
-	const llvm::Type * CompiledType::value () const {
-		return _type;
-	}
-	
-	void CompiledType::to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
-		buffer << "(compiled-type ";
-		
-		llvm::raw_os_ostream llvmBuffer(buffer);
-		_type->print(llvmBuffer);
-		llvmBuffer.flush();
-		
-		buffer << ")";
-	}
-	
-	Object * CompiledType::voidType (Frame * frame) {
-		return new CompiledType(llvm::Type::getVoidTy(llvm::getGlobalContext()));
-	}
-	
-	Object * CompiledType::intType (Frame * frame) {
-		Integer * bitSize;
-		
-		frame->extract()(bitSize);
-		
-		unsigned nbits = bitSize->value();
-		
-		if (nbits >= llvm::IntegerType::MIN_INT_BITS && nbits <= llvm::IntegerType::MAX_INT_BITS) {
-			switch (bitSize->value()) {
-				case 1:
-					return new CompiledType(llvm::Type::getInt1Ty(llvm::getGlobalContext()));
-				case 8:
-					return new CompiledType(llvm::Type::getInt8Ty(llvm::getGlobalContext()));
-				case 16:
-					return new CompiledType(llvm::Type::getInt16Ty(llvm::getGlobalContext()));
-				case 32:
-					return new CompiledType(llvm::Type::getInt32Ty(llvm::getGlobalContext()));
-				case 64:
-					return new CompiledType(llvm::Type::getInt64Ty(llvm::getGlobalContext()));
-				default:
-					return new CompiledType(llvm::IntegerType::get(llvm::getGlobalContext(), bitSize->value()));
+			Value generate_if(Cell * operands) {
+				if (!operands) {
+					return unsupported("Invalid If", operands);
+				}
+				
+				Value condition = generate(operands->head());
+				
+				Cell * branches = operands->tail().as<Cell>();
+				Object * true_branch = branches ? branches->head().get() : NULL;
+				Cell * rest = branches ? branches->tail().as<Cell>() : NULL;
+				Object * false_branch = rest ? rest->head().get() : NULL;
+				
+				// As in Kai, any integer is true, so only comparisons can choose the false branch:
+				if (!condition.boolean)
+					return true_branch ? generate(true_branch) : nothing(operands);
+				
+				llvm::BasicBlock * true_block = llvm::BasicBlock::Create(_context, "true", _function);
+				llvm::BasicBlock * false_block = llvm::BasicBlock::Create(_context, "false", _function);
+				llvm::BasicBlock * end_block = llvm::BasicBlock::Create(_context, "end", _function);
+				
+				_builder.CreateCondBr(condition.value, true_block, false_block);
+				
+				_builder.SetInsertPoint(true_block);
+				llvm::Value * true_value = to_word(true_branch ? generate(true_branch) : nothing(operands));
+				true_block = _builder.GetInsertBlock();
+				_builder.CreateBr(end_block);
+				
+				_builder.SetInsertPoint(false_block);
+				llvm::Value * false_value = to_word(false_branch ? generate(false_branch) : nothing(operands));
+				false_block = _builder.GetInsertBlock();
+				_builder.CreateBr(end_block);
+				
+				_builder.SetInsertPoint(end_block);
+				llvm::PHINode * result = _builder.CreatePHI(word(), 2);
+				result->addIncoming(true_value, true_block);
+				result->addIncoming(false_value, false_block);
+				
+				return integer(result);
 			}
-		}
-		
-		throw Exception("Invalid primative integer width!", bitSize, frame);
-	}
-	
-	Object * CompiledType::floatType (Frame * frame) {
-		Integer * bitSize;
-		
-		frame->extract()(bitSize);
-		
-		switch (bitSize->value()) {
-			case 32:
-				return new CompiledType(llvm::Type::getFloatTy(llvm::getGlobalContext()));
-			case 64:
-				return new CompiledType(llvm::Type::getDoubleTy(llvm::getGlobalContext()));
-			case 128:
-				return new CompiledType(llvm::Type::getFP128Ty(llvm::getGlobalContext()));
-		}
-
-		throw Exception("Invalid primative float width!", bitSize, frame);
-	}
-	
-	Object * CompiledType::functionType (Frame * frame) {
-		Cell * args = frame->unwrap();
-		
-		const llvm::Type* returnType = NULL;
-		std::vector<const llvm::Type*> argumentTypes;
-		bool varargs = false;
-		
-		while (args != NULL) {
-			CompiledType * element = args->head().as<CompiledType>();
 			
-			if (returnType == NULL)
-				returnType = element->value();
-			else
-				argumentTypes.push_back(element->value());
-
-			args = args->tail().as<Cell>();
-		}
-		
-		if (returnType == NULL) {
-			throw Exception("Invalid return type!", frame);
-		}
-		
-		return new CompiledType(llvm::FunctionType::get(returnType, argumentTypes, varargs));
-	}
-	
-	Object * CompiledType::structType (Frame * frame) {
-		Cell * args = frame->unwrap();
-		std::vector<const llvm::Type*> types;
-		bool packed = false;
-		
-		while (args != NULL) {
-			CompiledType * element = args->head().as<CompiledType>();
+			Value generate_return(Cell * operands) {
+				Value value = operands ? generate(operands->head()) : nothing(operands);
+				
+				_builder.CreateRet(_builder.CreateZExtOrTrunc(to_word(value), type(_signature->result())));
+				
+				// Anything following the return is unreachable, but still needs somewhere to go:
+				_builder.SetInsertPoint(llvm::BasicBlock::Create(_context, "unreachable", _function));
+				
+				return integer(llvm::UndefValue::get(word()));
+			}
 			
-			types.push_back(element->value());
+			/// Record the given fault if the condition is true.
+			void fault(llvm::Value * condition, Function::Fault fault) {
+				llvm::Value * faults = _builder.CreateLoad(_builder.getInt32Ty(), _fault);
+				llvm::Value * value = _builder.CreateSelect(condition, _builder.getInt32(fault), _builder.getInt32(0));
+				
+				_builder.CreateStore(_builder.CreateOr(faults, value), _fault);
+			}
 			
-			args = args->tail().as<Cell>();
-		}
-		
-		return new CompiledType(llvm::StructType::get(llvm::getGlobalContext(), types, packed));
-	}
-	
-	Object * CompiledType::arrayType (Frame * frame) {
-		CompiledType * elementType;
-		Integer * numberOfElements;
-		
-		frame->extract()(elementType)(numberOfElements);
-		
-		return new CompiledType(llvm::ArrayType::get(elementType->value(), numberOfElements->value()));
-	}
-	
-	Object * CompiledType::pointerType (Frame * frame) {
-		CompiledType * to;
-		
-		frame->extract()(to);
-		
-		return new CompiledType(to->value()->getPointerTo());
-	}
-	
-	Object * CompiledType::vectorType (Frame * frame) {
-		CompiledType * elementType;
-		Integer * numberOfElements;
-		
-		frame->extract()(elementType)(numberOfElements);
-		
-		return new CompiledType(llvm::VectorType::get(elementType->value(), numberOfElements->value()));
-	}
-	
-	void CompiledType::import (Table * context) {
-		context->update(frame->sym("void"), KAI_BUILTIN_FUNCTION(CompiledType::voidType));
-		
-		context->update(frame->sym("int"), KAI_BUILTIN_FUNCTION(CompiledType::intType));
-		context->update(frame->sym("float"), KAI_BUILTIN_FUNCTION(CompiledType::floatType));
-		context->update(frame->sym("function"), KAI_BUILTIN_FUNCTION(CompiledType::functionType));
-		
-		context->update(frame->sym("struct"), KAI_BUILTIN_FUNCTION(CompiledType::structType));
-		
-		context->update(frame->sym("array"), KAI_BUILTIN_FUNCTION(CompiledType::arrayType));
-		context->update(frame->sym("pointer"), KAI_BUILTIN_FUNCTION(CompiledType::pointerType));
-		context->update(frame->sym("vector"), KAI_BUILTIN_FUNCTION(CompiledType::vectorType));
-	}
-
-// MARK: -
-	
-	CompiledObject::CompiledValue (llvm::Object * value) : _value(value)  {
-	
-	}
-	
-	CompiledObject::~CompiledValue () {
-	
-	}
-
-	// Returns the contained value.
-	llvm::Object * CompiledObject::compile (Frame * frame) {
-		return _value;
-	}
-	
-	void CompiledObject::to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
-		buffer << "(compiled-value ";
-		
-		llvm::raw_os_ostream llvmBuffer(buffer);
-		_value->print(llvmBuffer);
-		llvmBuffer.flush();
+			/// If the divisor is zero, the fault is recorded and one is used instead, so that the function still completes.
+			llvm::Value * checked_divisor(llvm::Value * divisor) {
+				llvm::Value * zero = _builder.CreateICmpEQ(divisor, _builder.getInt64(0));
+				
+				fault(zero, Function::DIVISION_BY_ZERO);
+				
+				return _builder.CreateSelect(zero, _builder.getInt64(1), divisor);
+			}
+			
+			/// Kai integers don't overflow, so exact code records a fault instead, and is evaluated again by the interpreter.
+			llvm::Value * checked_arithmetic(llvm::Intrinsic::ID intrinsic, llvm::Value * lhs, llvm::Value * rhs) {
+				llvm::Value * result = _builder.CreateBinaryIntrinsic(intrinsic, lhs, rhs);
+				
+				fault(_builder.CreateExtractValue(result, 1), Function::INTEGER_OVERFLOW);
+				
+				return _builder.CreateExtractValue(result, 0);
+			}
+			
+			// [receiver operator argument] is parsed as (call receiver (value (operator argument))).
+			Value generate_operator(Cell * message) {
+				Cell * operands = message->tail().as<Cell>();
+				Cell * rest = operands ? operands->tail().as<Cell>() : NULL;
+				Cell * quote = rest ? rest->head().as<Cell>() : NULL;
+				Cell * quoted = quote ? quote->tail().as<Cell>() : NULL;
+				Cell * body = quoted ? quoted->head().as<Cell>() : NULL;
+				
+				Symbol * name = body ? body->head().as<Symbol>() : NULL;
+				Cell * arguments = body ? body->tail().as<Cell>() : NULL;
+				
+				if (!name || !arguments || arguments->tail()) {
+					return unsupported("Unsupported Method Call", message);
+				}
+				
+				llvm::Value * lhs = to_word(generate(operands->head()));
+				llvm::Value * rhs = to_word(generate(arguments->head()));
+				
+				const StringT & op = name->value();
+				
+				// Only the operators which Kai integers provide can be used by exact code:
+				if (_exact) {
+					if (op == "+") return integer(checked_arithmetic(llvm::Intrinsic::uadd_with_overflow, lhs, rhs));
+					if (op == "-") return integer(checked_arithmetic(llvm::Intrinsic::usub_with_overflow, lhs, rhs));
+					if (op == "*") return integer(checked_arithmetic(llvm::Intrinsic::umul_with_overflow, lhs, rhs));
+					if (op == "%") return integer(_builder.CreateURem(lhs, checked_divisor(rhs)));
+					if (op == "==") return Value{_builder.CreateICmpEQ(lhs, rhs), true};
+					
+					return unsupported("Unsupported Operator", name);
+				}
+				
+				if (op == "+") return integer(_builder.CreateAdd(lhs, rhs));
+				if (op == "-") return integer(_builder.CreateSub(lhs, rhs));
+				if (op == "*") return integer(_builder.CreateMul(lhs, rhs));
+				if (op == "/") return integer(_builder.CreateUDiv(lhs, checked_divisor(rhs)));
+				if (op == "%") return integer(_builder.CreateURem(lhs, checked_divisor(rhs)));
+				if (op == "&") return integer(_builder.CreateAnd(lhs, rhs));
+				if (op == "|") return integer(_builder.CreateOr(lhs, rhs));
+				if (op == "^") return integer(_builder.CreateXor(lhs, rhs));
+				
+				// Shifts by 64 bits or more are undefined in LLVM, so the amount is masked as it would be by the hardware:
+				if (op == "<<") return integer(_builder.CreateShl(lhs, _builder.CreateAnd(rhs, 63)));
+				if (op == ">>") return integer(_builder.CreateLShr(lhs, _builder.CreateAnd(rhs, 63)));
+				
+				if (op == "==") return Value{_builder.CreateICmpEQ(lhs, rhs), true};
+				if (op == "!=") return Value{_builder.CreateICmpNE(lhs, rhs), true};
+				if (op == "<") return Value{_builder.CreateICmpULT(lhs, rhs), true};
+				if (op == ">") return Value{_builder.CreateICmpUGT(lhs, rhs), true};
+				if (op == "<=") return Value{_builder.CreateICmpULE(lhs, rhs), true};
+				if (op == ">=") return Value{_builder.CreateICmpUGE(lhs, rhs), true};
+				
+				return unsupported("Unsupported Operator", name);
+			}
+			
+			Value generate_call(llvm::Function * callee, Signature * signature, Cell * operands, Cell * message) {
+				const Signature::ArgumentsT & types = signature->arguments();
+				std::vector<llvm::Value *> arguments;
+				
+				for (; operands != NULL; operands = operands->tail().as<Cell>()) {
+					if (arguments.size() == types.size()) {
+						return unsupported("Compiled Function Arity Mismatch", message);
+					}
+					
+					llvm::Value * argument = to_word(generate(operands->head()));
+					arguments.push_back(_builder.CreateZExtOrTrunc(argument, type(types[arguments.size()])));
+				}
+				
+				if (arguments.size() != types.size()) {
+					return unsupported("Compiled Function Arity Mismatch", message);
+				}
+				
+				arguments.push_back(_fault);
+				
+				llvm::Value * result = _builder.CreateCall(callee, arguments);
+				
+				return integer(_builder.CreateZExt(result, word()));
+			}
+			
+			void generate_entry() {
+				llvm::Type * words = llvm::PointerType::getUnqual(word());
+				llvm::Type * fault = llvm::PointerType::getUnqual(_builder.getInt32Ty());
+				
+				llvm::FunctionType * entry_type = llvm::FunctionType::get(word(), {words, fault}, false);
+				llvm::Function * entry = llvm::Function::Create(entry_type, llvm::Function::ExternalLinkage, _symbol + ".entry", _module);
+				
+				_builder.SetInsertPoint(llvm::BasicBlock::Create(_context, "entry", entry));
+				
+				std::vector<llvm::Value *> arguments;
+				const Signature::ArgumentsT & types = _signature->arguments();
+				
+				for (std::size_t i = 0; i < types.size(); i += 1) {
+					llvm::Value * address = _builder.CreateConstGEP1_64(word(), entry->getArg(0), i);
+					llvm::Value * value = _builder.CreateLoad(word(), address);
+					
+					arguments.push_back(_builder.CreateTrunc(value, type(types[i])));
+				}
+				
+				arguments.push_back(entry->getArg(1));
+				
+				llvm::Value * result = _builder.CreateCall(_function, arguments);
+				_builder.CreateRet(_builder.CreateZExt(result, word()));
+			}
+			
+		public:
+			Generator(Frame * frame, Symbol * name, Lambda * lambda, Signature * signature, const std::string & symbol, llvm::Module & module, bool exact) : _frame(frame), _name(name), _lambda(lambda), _signature(signature), _symbol(symbol), _context(module.getContext()), _module(module), _builder(module.getContext()), _function(NULL), _fault(NULL), _exact(exact) {
+			}
+			
+			void generate(Cell * names, Object * body) {
+				_function = llvm::Function::Create(function_type(_signature), llvm::Function::ExternalLinkage, _symbol, _module);
+				
+				_builder.SetInsertPoint(llvm::BasicBlock::Create(_context, "entry", _function));
+				
+				// Arguments are widened to 64 bits on entry:
+				std::size_t index = 0;
+				
+				for (; names != NULL; names = names->tail().as<Cell>(), index += 1) {
+					Symbol * name = names->head().as<Symbol>();
+					
+					if (!name || index == _signature->arguments().size()) {
+						throw Exception("Invalid Arguments", names, _frame);
+					}
+					
+					llvm::Argument * argument = _function->getArg(index);
+					argument->setName(name->value());
+					
+					_arguments.push_back(std::make_pair(name->value(), _builder.CreateZExt(argument, word())));
+				}
+				
+				if (index != _signature->arguments().size()) {
+					throw Exception("Compiled Function Arity Mismatch", _signature, _frame);
+				}
+				
+				_fault = _function->getArg(index);
+				
+				Value result = generate(body);
+				
+				_builder.CreateRet(_builder.CreateZExtOrTrunc(to_word(result), type(_signature->result())));
+				
+				generate_entry();
+			}
+		};
 		
-		buffer << ")";
-	}
-	
-	Object * CompiledObject::prototype () {
-		return globalPrototype();
-	}
-	
-	class BuiltinLoad : public Value {
-	public:
-		virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
-			buffer << "(builtin-load)";
+		Function * Compiler::compile(Frame * frame, Symbol * name, Lambda * lambda, Signature * signature, Cell * arguments, Object * body, bool exact) {
+			Engine * engine = Engine::shared(frame);
+			std::string symbol = engine->unique_name(name ? name->value() : "lambda");
+			
+			std::unique_ptr<llvm::LLVMContext> context(new llvm::LLVMContext);
+			std::unique_ptr<llvm::Module> module(new llvm::Module(symbol, *context));
+			
+			Generator generator(frame, name, lambda, signature, symbol, *module, exact);
+			generator.generate(arguments, body);
+			
+			std::string code;
+			llvm::raw_string_ostream output(code);
+			module->print(output, NULL);
+			
+			engine->add(frame, std::move(module), std::move(context));
+			
+			return new(frame) Function(symbol, signature, engine->lookup(frame, symbol + ".entry"), output.str());
 		}
 		
-		virtual Object * evaluate (Frame * frame) {
-			return new CompiledValue(this->compile(frame));
+		Ref<Object> Compiler::compiler(Frame * frame) {
+			Symbol * name;
+			Signature * signature;
+			Cell * arguments = NULL;
+			Object * body = NULL;
+			
+			frame->extract()(name, "name")(signature, "signature")[arguments][body];
+			
+			return compile(frame, name, NULL, signature, arguments, body);
 		}
 		
-		virtual llvm::Object * compile (Frame * frame) {
-			Compiler * c = frame->lookupAs<Compiler>(frame->sym("compiler"));
+		Ref<Object> Compiler::jit(Frame * frame) {
+			Lambda * lambda;
 			
-			Object * varExpr;
-			frame->extract()(varExpr);
+			frame->extract()(lambda, "lambda");
 			
-			llvm::Object * var = varExpr->compile(frame);
+			if (lambda->is_macro()) {
+				throw Exception("Unsupported Macro", lambda, frame);
+			}
 			
-			return c->builder()->CreateLoad(var);
-		}
-	};
-	
-	class BuiltinStore : public Value {
-	public:
-		virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
-			buffer << "(builtin-store)";
+			// Every argument and the result are 64-bit natural numbers:
+			Type * word = new(frame) Type(64);
+			Signature::ArgumentsT types(lambda->arity(), word);
+			
+			Signature * signature = new(frame) Signature(word, types);
+			
+			return compile(frame, NULL, lambda, signature, lambda->arguments(), lambda->body());
 		}
 		
-		virtual Object * evaluate (Frame * frame) {
-			return new CompiledValue(this->compile(frame));
+		NativeCode * Compiler::promote(Frame * frame, Lambda * lambda) {
+			// Names in the body are resolved in the scope of the lambda, rather than its caller:
+			Frame * scope = lambda->scope();
+			
+			Type * word = new(scope) Type(64);
+			Signature::ArgumentsT types(lambda->arity(), word);
+			
+			Signature * signature = new(scope) Signature(word, types);
+			
+			try {
+				return compile(scope, NULL, lambda, signature, lambda->arguments(), lambda->body(), true);
+			} catch (Exception & exception) {
+				// Most lambdas use something which can't be compiled, and are left in a lower tier:
+				return NULL;
+			}
 		}
 		
-		virtual llvm::Object * compile (Frame * frame) {
-			Compiler * c = frame->lookupAs<Compiler>(frame->sym("compiler"));
+		void Compiler::import(Frame * frame) {
+			Function::import(frame);
 			
-			Object * varExpr;
-			Object * valueExpr;
+			frame->update(frame->sym("int"), KAI_BUILTIN_FUNCTION(Type::integer));
+			frame->update(frame->sym("function"), KAI_BUILTIN_FUNCTION(Signature::function));
 			
-			frame->extract()(varExpr)(valueExpr);
+			frame->update(frame->sym("compiler"), KAI_BUILTIN_FUNCTION(Compiler::compiler));
+			frame->update(frame->sym("jit"), KAI_BUILTIN_FUNCTION(Compiler::jit));
 			
-			llvm::Object * var = varExpr->compile(frame);
-			llvm::Object * value = valueExpr->compile(frame);
-			
-			return c->builder()->CreateStore(value, var);
-		}
-	};
-	
-	Object * CompiledObject::globalPrototype () {
-		static Ref<Table> g_prototype;
-		
-		if (!g_prototype) {
-			g_prototype = new Table;
-			g_prototype->set_prototype(Object::globalPrototype());
-			
-			g_prototype->update(frame->sym("load"), new BuiltinLoad);
-			g_prototype->update(frame->sym("store"), new BuiltinStore);
-			g_prototype->update(frame->sym("=="), new IntegerEquality);
-			g_prototype->update(frame->sym("%"), new IntegerModulus);
+			Tiering::set_native_compiler(Compiler::promote);
 		}
 		
-		return g_prototype;
 	}
-	
-	void CompiledObject::import (Table * context) {
-		context->update(frame->sym("CompiledValue"), CompiledObject::globalPrototype());
-	}
-
 }
@@ -6,136 +6,148 @@
 //  Copyright 2010 Samuel Williams. All rights reserved.
 //
 //
- 
-#include "Value.hpp"
 
-#include <llvm/LLVMContext.h>
-#include <llvm/ExecutionEngine/ExecutionEngine.h>
-#include <llvm/Support/IRBuilder.h>
-#include <llvm/Support/StandardPasses.h>
+#ifndef _KAI_JIT_COMPILER_H
+#define _KAI_JIT_COMPILER_H
+
+#include "Engine.hpp"
+
+#include <Kai/Tiering.hpp>
+
+#include <vector>
 
 namespace Kai {
 	
-	class DynamicFunction;
-	class CompiledFunction;
+	class Cell;
+	class Symbol;
+	class Lambda;
 	
-	class Compiler : public Value {
+	namespace JIT {
+		
+		/// An unsigned integer type of the given width, since Kai integers are natural numbers.
+		class Type : public Object {
 		protected:
-			llvm::ExecutionEngine * _engine;
-			llvm::Module * _module;
-			llvm::IRBuilder<> * _builder;
-			
-			llvm::FunctionPassManager * _functionOptimizer;
-			llvm::PassManager * _moduleOptimizer;
+			unsigned _bits;
 			
-			const llvm::Type * _frameType;
-			const llvm::Type * _valueType;			
 		public:
-			Compiler ();
-			virtual ~Compiler ();
+			static const char * const NAME;
 			
-			// Returns a compiled function corresponding to the given arguments.
-			virtual Object * evaluate (Frame * frame);
+			Type(unsigned bits);
+			virtual ~Type();
 			
-			// Lookup a compiled function with a given name
-			virtual Object * lookup (Symbol * identifier);
+			virtual Ref<Symbol> identity(Frame * frame) const;
 			
-			// A prototype specifies the behaviour of the current value.
-			virtual Object * prototype ();
+			unsigned bits() const { return _bits; }
 			
-			virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const;
-			
-			virtual DynamicFunction * resolve (CompiledFunction *);
+			virtual ComparisonResult compare(const Object * other) const;
+			ComparisonResult compare(const Type * other) const;
 			
-			llvm::ExecutionEngine * engine ();
-			llvm::Module * module ();
-			llvm::IRBuilder<> * builder ();
-			llvm::FunctionPassManager * functionOptimizer ();
-			llvm::PassManager * moduleOptimizer ();
-			
-			const llvm::Type * framePointerType ();
-			const llvm::Type * valuePointerType ();
+			virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const;
 			
-			static void import (Table * context);			
-	};
+			//% (int bits)
+			static Ref<Object> integer(Frame * frame);
+		};
 		
-	class CompiledValue : public Value {
+		/// The result and argument types of a compiled function.
+		class Signature : public Object {
+		public:
+			typedef std::vector<Type *> ArgumentsT;
+			
 		protected:
-			llvm::Object * _value;
-		
+			Type * _result;
+			ArgumentsT _arguments;
+			
 		public:
-			CompiledValue (llvm::Object * value);
-			virtual ~CompiledValue ();
+			static const char * const NAME;
 			
-			// Returns the contained value.
-			llvm::Object * compile (Frame * frame);
+			Signature(Type * result, const ArgumentsT & arguments);
+			virtual ~Signature();
 			
-			virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const;
+			virtual Ref<Symbol> identity(Frame * frame) const;
 			
-			virtual Object * prototype ();
+			virtual void mark(Memory::Traversal * traversal) const;
 			
-			static Object * globalPrototype ();
-			static void import (Table * context);
-	};
-	
-	class CompiledFunction : public Value {
+			Type * result() const { return _result; }
+			const ArgumentsT & arguments() const { return _arguments; }
+			
+			virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const;
+			
+			//% (function result-type argument-types...)
+			static Ref<Object> function(Frame * frame);
+		};
+		
+		/// A function which has been compiled to native code. When applied, its arguments must be integers which fit the signature.
+		class Function : public NativeCode {
 		public:
-			typedef std::vector<llvm::Type*> TypeSignatureT;
-
+			/// The faults which compiled code can record, e.g. instead of dividing by zero.
+			enum Fault {
+				DIVISION_BY_ZERO = 1,
+				INTEGER_OVERFLOW = 2
+			};
+			
 		protected:
-			friend class Compiler;
-			llvm::Function * _code;
-					
+			/// The name of the native function, which other compiled functions call directly.
+			std::string _name;
+			Signature * _signature;
+			
+			EntryT _entry;
+			
+			/// The generated code, before it was optimised.
+			StringT _code;
+			
 		public:
-			CompiledFunction(llvm::Function * code);
-			virtual ~CompiledFunction ();
-						
-			virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const;
+			static const char * const NAME;
 			
-			virtual Object * prototype ();
+			Function(const std::string & name, Signature * signature, EntryT entry, const StringT & code);
+			virtual ~Function();
 			
-			virtual Object * evaluate (Frame * frame);
+			virtual Ref<Symbol> identity(Frame * frame) const;
 			
-			virtual llvm::Object * compile (Frame * frame);
-			virtual llvm::Object * compiledValue (Frame * frame);
+			virtual void mark(Memory::Traversal * traversal) const;
 			
-			static Object * code(Frame * frame);
-			static Object * optimize(Frame * frame);
-			static Object * resolve(Frame * frame);
+			const std::string & name() const { return _name; }
+			Signature * signature() const { return _signature; }
 			
-			static void import (Table * context);
-				
-			static Object * globalPrototype ();
-	};
-	
-	class CompiledType : public Value {
-		protected:
-			const llvm::Type * _type;
-		
-		public:
-			CompiledType (const llvm::Type *);
-			virtual ~CompiledType ();
+			/// Convert the arguments and call the native code. Returns the faults which were recorded, or -1 if the arguments don't fit the signature.
+			int apply(Frame * frame, Object ** arguments, std::size_t count, Ref<Object> & result);
 			
-			const llvm::Type * value () const;
-						
-			static Object * globalIntegerPrototype ();
+			virtual bool call(Frame * frame, Object ** arguments, std::size_t count, Ref<Object> & result);
+			
+			virtual Ref<Object> evaluate(Frame * frame);
 			
 			virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const;
 			
-			static Object * voidType (Frame * frame);
+			//% [function code] -> string
+			static Ref<Object> code(Frame * frame);
+			
+			static void import(Frame * frame);
+		};
+		
+		/** Compiles a small, statically typed subset of Kai to native code: integer literals, arguments, block, if, return, the arithmetic, bitwise and comparison operators using method call syntax, and calls to compiled functions, including recursive calls.
+		 
+		 Exact code must produce the same result as the interpreter, so it only uses operators which Kai integers provide, records a fault if the arithmetic overflows, and can't produce booleans or nil where the interpreter would.
+		 
+		 Arithmetic is performed on 64-bit unsigned values, which are truncated to the declared result type. Comparisons produce booleans, so that as in Kai, `if` only considers a comparison to be false; an integer condition is always true.
+		 */
+		class Compiler {
+		public:
+			/// Compile the given body to a native function.
+			static Function * compile(Frame * frame, Symbol * name, Lambda * lambda, Signature * signature, Cell * arguments, Object * body, bool exact = false);
 			
-			static Object * intType (Frame * frame);
-			static Object * floatType (Frame * frame);
-			static Object * functionType (Frame * frame);
+			/// Compile exact native code for a hot lambda, or return NULL if it uses anything which isn't supported.
+			static NativeCode * promote(Frame * frame, Lambda * lambda);
 			
-			static Object * structType (Frame * frame);
+			//% (compiler name signature arguments body)
+			static Ref<Object> compiler(Frame * frame);
 			
-			static Object * arrayType (Frame * frame);
-			static Object * pointerType (Frame * frame);
-			static Object * vectorType (Frame * frame);
+			/// Compile a lambda whose arguments and result are 64-bit natural numbers. The arithmetic wraps rather than growing, so this is only suitable for hot code with bounded values.
+			//% (jit lambda)
+			static Ref<Object> jit(Frame * frame);
 			
-			static void import (Table * context);
-	};
-
+			static void import(Frame * frame);
+		};
+		
+	}
 }
 
+#endif
@@ -0,0 +1,108 @@
+//
+//  Engine.cpp
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#include "Engine.hpp"
+
+#include <Kai/Frame.hpp>
+#include <Kai/Exception.hpp>
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace Kai {
+	namespace JIT {
+		
+		static StringT error_message(llvm::Error error) {
+			return llvm::toString(std::move(error));
+		}
+		
+		Engine::Engine() : _modules(0) {
+		}
+		
+		Engine::~Engine() {
+		}
+		
+		Engine * Engine::shared(Frame * frame) {
+			static std::unique_ptr<Engine> engine;
+			
+			if (!engine) {
+				llvm::InitializeNativeTarget();
+				llvm::InitializeNativeTargetAsmPrinter();
+				
+				llvm::Expected<std::unique_ptr<llvm::orc::LLJIT>> jit = llvm::orc::LLJITBuilder().create();
+				
+				if (!jit) {
+					throw Exception("JIT Unavailable: " + error_message(jit.takeError()), frame);
+				}
+				
+				engine.reset(new Engine);
+				engine->_jit = std::move(*jit);
+			}
+			
+			return engine.get();
+		}
+		
+		std::string Engine::unique_name(const std::string & prefix) {
+			_modules += 1;
+			
+			return prefix + "." + std::to_string(_modules);
+		}
+		
+		void Engine::add(Frame * frame, std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context) {
+			module->setDataLayout(_jit->getDataLayout());
+			module->setTargetTriple(_jit->getTargetTriple().str());
+			
+			std::string errors;
+			llvm::raw_string_ostream output(errors);
+			
+			if (llvm::verifyModule(*module, &output)) {
+				throw Exception("Invalid Compiled Code: " + output.str(), frame);
+			}
+			
+			llvm::LoopAnalysisManager loop_analysis;
+			llvm::FunctionAnalysisManager function_analysis;
+			llvm::CGSCCAnalysisManager cgscc_analysis;
+			llvm::ModuleAnalysisManager module_analysis;
+			
+			llvm::PassBuilder builder;
+			builder.registerModuleAnalyses(module_analysis);
+			builder.registerCGSCCAnalyses(cgscc_analysis);
+			builder.registerFunctionAnalyses(function_analysis);
+			builder.registerLoopAnalyses(loop_analysis);
+			builder.crossRegisterProxies(loop_analysis, function_analysis, cgscc_analysis, module_analysis);
+			
+			// Among other things, this turns self recursion in tail position into loops:
+			llvm::ModulePassManager passes = builder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+			passes.run(*module, module_analysis);
+			
+			llvm::Error error = _jit->addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
+			
+			if (error) {
+				throw Exception("JIT Error: " + error_message(std::move(error)), frame);
+			}
+		}
+		
+		EntryT Engine::lookup(Frame * frame, const std::string & name) {
+			auto symbol = _jit->lookup(name);
+			
+			if (!symbol) {
+				throw Exception("JIT Error: " + error_message(symbol.takeError()), frame);
+			}
+			
+#if LLVM_VERSION_MAJOR >= 15
+			return symbol->toPtr<EntryT>();
+#else
+			return reinterpret_cast<EntryT>(symbol->getAddress());
+#endif
+		}
+		
+	}
+}
@@ -0,0 +1,56 @@
+//
+//  Engine.h
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#ifndef _KAI_JIT_ENGINE_H
+#define _KAI_JIT_ENGINE_H
+
+#include <Kai/Object.hpp>
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+#include <memory>
+
+namespace Kai {
+	namespace JIT {
+		
+		/// The entry point of every compiled function, which takes its arguments as an array of 64-bit values. If the function faults, e.g. by dividing by zero, the fault is set and the result is undefined.
+		typedef uint64_t (*EntryT)(const uint64_t * arguments, uint32_t * fault);
+		
+		/** Wraps an in-process ORC LLJIT instance. Modules are optimised before they are added, and every module shares the same symbol table, so compiled functions can call each other by name.
+		 */
+		class Engine {
+		protected:
+			std::unique_ptr<llvm::orc::LLJIT> _jit;
+			
+			std::size_t _modules;
+			
+			Engine();
+			
+		public:
+			~Engine();
+			
+			/// The engine is created on first use, so that the interpreter doesn't pay for LLVM unless it is used.
+			static Engine * shared(Frame * frame);
+			
+			/// A unique name for a new module or function.
+			std::string unique_name(const std::string & prefix);
+			
+			/// Optimise the module and add it to the engine. The module is verified first, so invalid code throws an exception rather than crashing.
+			void add(Frame * frame, std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context);
+			
+			/// Find the address of a compiled entry point.
+			EntryT lookup(Frame * frame, const std::string & name);
+		};
+		
+	}
+}
+
+#endif
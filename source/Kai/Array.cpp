@@ -19,7 +19,7 @@ namespace Kai {
 	
 	const char * const Array::NAME = "Array";
 	
-	Array::Array() {
+	Array::Array() : Object(ARRAY_TAG) {
 	}
 	
 	Array::~Array() {
@@ -85,13 +85,12 @@ namespace Kai {
 	Ref<Object> Array::new_ (Frame * frame)
 	{
 		Array * array = new(frame) Array();
-		Cell * items = frame->unwrap()->tail().as<Cell>();
+		std::size_t count = frame->evaluate_arguments();
+		Object ** items = frame->argument_values();
 		
-		while (items) {
-			array->_value.push_back(items->head());
-			
-			items = items->tail().as<Cell>();
-		}
+		// Skip self:
+		if (count > 1)
+			array->_value.insert(array->_value.end(), items + 1, items + count);
 		
 		return array;
 	}
@@ -154,12 +153,12 @@ namespace Kai {
 		Array * self = NULL;
 		
 		ArgumentExtractor arguments = frame->extract()(self);
-
+		
 		while (arguments) {
 			Object * item = nullptr;
-
+			
 			arguments = arguments(item, "item", false);
-
+			
 			self->_value.push_front(item);
 		}
 		
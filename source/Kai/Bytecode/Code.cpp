@@ -0,0 +1,123 @@
+//
+//  Code.cpp
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#include "Code.hpp"
+#include "Machine.hpp"
+#include "../Frame.hpp"
+#include "../Cell.hpp"
+#include "../Symbol.hpp"
+
+#include <iomanip>
+
+namespace Kai {
+	namespace Bytecode {
+		
+		static const char * const OPERATION_NAMES[] = {
+			"constant", "evaluate", "lookup", "lexical", "pop",
+			"jump", "branch", "or",
+			"guard", "dispatch", "invoke", "tail-invoke", "apply",
+			"method", "send", "call",
+			"return", "complete",
+		};
+		
+		const char * const Code::NAME = "Code";
+		
+		Code::Code(Object * expression) : Object(CODE_TAG), _expression(expression), _depth(0) {
+		}
+		
+		Code::~Code() {
+		}
+		
+		Ref<Symbol> Code::identity(Frame * frame) const {
+			return frame->sym(NAME);
+		}
+		
+		void Code::mark(Memory::Traversal * traversal) const {
+			traversal->traverse(_expression);
+			
+			for (ConstantsT::const_iterator constant = _constants.begin(); constant != _constants.end(); ++constant) {
+				traversal->traverse(*constant);
+			}
+			
+			for (SitesT::const_iterator site = _sites.begin(); site != _sites.end(); ++site) {
+				traversal->traverse(site->message);
+				traversal->traverse(site->name);
+			}
+		}
+		
+		Ref<Object> Code::evaluate(Frame * frame) {
+			return Machine::run(frame, this);
+		}
+		
+		void Code::disassemble(Frame * frame, std::ostream & output) const {
+			for (std::size_t pc = 0; pc < _instructions.size(); pc += 1) {
+				const Instruction & instruction = _instructions[pc];
+				
+				output << std::setw(4) << pc << " " << OPERATION_NAMES[instruction.operation];
+				
+				switch (instruction.operation) {
+					case CONSTANT:
+					case EVALUATE:
+					case LOOKUP:
+					case LEXICAL:
+						output << " " << Object::to_string(frame, _constants[instruction.a]);
+						break;
+					
+					case JUMP:
+					case BRANCH:
+					case OR:
+						output << " -> " << instruction.a;
+						break;
+					
+					case GUARD:
+						output << " " << Object::to_string(frame, _constants[instruction.a]) << " else -> " << instruction.b;
+						break;
+					
+					case DISPATCH:
+					case METHOD:
+						output << " #" << instruction.a << " else -> " << instruction.b;
+						break;
+					
+					case INVOKE:
+					case TAIL_INVOKE:
+					case APPLY:
+					case SEND:
+					case CALL:
+						output << " #" << instruction.a << " " << Object::to_string(frame, _sites[instruction.a].message);
+						break;
+					
+					case RETURN:
+						if (instruction.a != NONE)
+							output << " -> " << instruction.a;
+						break;
+					
+					case COMPLETE:
+						output << " " << instruction.a;
+						break;
+					
+					default:
+						break;
+				}
+				
+				output << std::endl;
+			}
+		}
+		
+		void Code::to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
+			buffer << "(code@" << this << " ";
+			
+			if (_expression)
+				_expression->to_code(frame, buffer, marks, indentation + 1);
+			else
+				buffer << "nil";
+			
+			buffer << ")";
+		}
+		
+	}
+}
@@ -0,0 +1,146 @@
+//
+//  Code.h
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#ifndef _KAI_BYTECODE_CODE_H
+#define _KAI_BYTECODE_CODE_H
+
+#include "../Object.hpp"
+
+#include <vector>
+
+namespace Kai {
+	
+	class Cell;
+	
+	namespace Bytecode {
+		
+		/// The operations of the stack machine. Operands refer to the constants, sites and instructions of the code being executed.
+		enum Operation : uint8_t {
+			/// Push constants[a].
+			CONSTANT,
+			/// Push the result of evaluating constants[a], which is a literal value.
+			EVALUATE,
+			/// Push the value of the symbol constants[a].
+			LOOKUP,
+			/// Push the value of the lexical symbol constants[a].
+			LEXICAL,
+			/// Discard the top of the stack.
+			POP,
+			
+			/// Continue at instruction a.
+			JUMP,
+			/// Pop the top of the stack, and continue at instruction a if it is false.
+			BRANCH,
+			/// If the top of the stack is true, continue at instruction a, otherwise pop it.
+			OR,
+			
+			/// If the top of the stack is the builtin constants[a], pop it. Otherwise, continue at instruction b, where the message is applied normally.
+			GUARD,
+			/// If the function below the operands of sites[a] is a lambda which evaluates its arguments, continue. Otherwise, continue at instruction b.
+			DISPATCH,
+			/// Invoke the lambda below the arguments of sites[a] with the arguments.
+			INVOKE,
+			/// As above, but the lambda replaces the current activation if possible.
+			TAIL_INVOKE,
+			/// Apply the function on the top of the stack to the message of sites[a], evaluating the operands only if the function requires them.
+			APPLY,
+			
+			/// Look up the method sites[a] for the receiver on the top of the stack, which is replaced by the method and the receiver. If the method is a lambda which evaluates its arguments, continue. Otherwise, continue at instruction b.
+			METHOD,
+			/// Apply the method below the receiver to the remaining operands of sites[a].
+			SEND,
+			/// Apply the method call body on the top of the stack to the receiver below it, as Object::call would.
+			CALL,
+			
+			/// Request a return of the value on the top of the stack, and unwind to handler a.
+			RETURN,
+			/// Complete a pending return, by truncating the stack to a values and pushing the returned value.
+			COMPLETE,
+		};
+		
+		enum {
+			/// The handler of an instruction which isn't inside a block, so that returns unwind out of the code entirely.
+			NONE = 0xFFFFFFFF
+		};
+		
+		struct Instruction {
+			Operation operation;
+			
+			uint32_t a, b;
+		};
+		
+		/// A place in the code where a message is sent.
+		struct Site {
+			/// The message as it appears in the source code, used when falling back to the evaluator.
+			Cell * message;
+			
+			/// The name of the method, for method calls.
+			Symbol * name;
+			
+			/// The number of values passed as arguments.
+			uint32_t count;
+			
+			/// The compiled operands are the instructions from entry up to but not including stop, which start at the given stack depth.
+			uint32_t entry, stop, depth;
+			
+			/// Where to continue if a return is pending once the message has been sent.
+			uint32_t handler;
+		};
+		
+		/** Compiled code for an expression, executed by the Machine.
+		
+		 When applied as a function, the code is executed in the frame of the caller, so `(c)` is equivalent to evaluating the original expression.
+		 */
+		class Code : public Object {
+		public:
+			typedef std::vector<Instruction> InstructionsT;
+			typedef std::vector<Object *> ConstantsT;
+			typedef std::vector<Site> SitesT;
+			
+		protected:
+			Object * _expression;
+			
+			InstructionsT _instructions;
+			ConstantsT _constants;
+			SitesT _sites;
+			
+			/// The maximum number of values on the stack while executing the code.
+			std::size_t _depth;
+			
+			friend class Compiler;
+			
+		public:
+			static const char * const NAME;
+			
+			Code(Object * expression);
+			virtual ~Code();
+			
+			virtual Ref<Symbol> identity(Frame * frame) const;
+			
+			virtual void mark(Memory::Traversal * traversal) const;
+			
+			Object * expression() const { return _expression; }
+			
+			const InstructionsT & instructions() const { return _instructions; }
+			const ConstantsT & constants() const { return _constants; }
+			const SitesT & sites() const { return _sites; }
+			
+			std::size_t depth() const { return _depth; }
+			
+			/// Execute the code in the given frame.
+			virtual Ref<Object> evaluate(Frame * frame);
+			
+			void disassemble(Frame * frame, std::ostream & output) const;
+			
+			virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const;
+		};
+		
+	}
+}
+
+#endif
@@ -0,0 +1,465 @@
+//
+//  Compiler.cpp
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#include "Compiler.hpp"
+#include "../Frame.hpp"
+#include "../Cell.hpp"
+#include "../Symbol.hpp"
+#include "../String.hpp"
+#include "../Lambda.hpp"
+#include "../Logic.hpp"
+#include "../Function.hpp"
+
+namespace Kai {
+	namespace Bytecode {
+		
+		Compiler::Compiler(Frame * frame, Code * code, bool body) : _frame(frame), _code(code), _body(body), _depth(0), _handler(NONE) {
+		}
+		
+		uint32_t Compiler::constant(Object * value) {
+			Code::ConstantsT & constants = _code->_constants;
+			
+			for (std::size_t i = 0; i < constants.size(); i += 1) {
+				if (constants[i] == value)
+					return i;
+			}
+			
+			constants.push_back(value);
+			
+			return constants.size() - 1;
+		}
+		
+		uint32_t Compiler::site(Cell * message, Symbol * name, uint32_t count) {
+			Site site = {message, name, count, NONE, NONE, 0, _handler};
+			
+			_code->_sites.push_back(site);
+			
+			return _code->_sites.size() - 1;
+		}
+		
+		uint32_t Compiler::emit(Operation operation, uint32_t a, uint32_t b) {
+			Instruction instruction = {operation, a, b};
+			
+			_code->_instructions.push_back(instruction);
+			
+			return _code->_instructions.size() - 1;
+		}
+		
+		uint32_t Compiler::here() const {
+			return _code->_instructions.size();
+		}
+		
+		void Compiler::push(std::size_t count) {
+			_depth += count;
+			
+			if (_depth > _code->_depth)
+				_code->_depth = _depth;
+		}
+		
+		void Compiler::pop(std::size_t count) {
+			_depth -= count;
+		}
+		
+		uint32_t Compiler::guard(Cell * message, Object * builtin) {
+			emit(LOOKUP, constant(message->head()));
+			push();
+			
+			uint32_t check = emit(GUARD, constant(builtin));
+			pop();
+			
+			return check;
+		}
+		
+		void Compiler::fallback(uint32_t guard, Cell * message, ExitsT & exits) {
+			exits.push_back(emit(JUMP));
+			
+			// The function is still on the stack, in place of the result:
+			_code->_instructions[guard].b = here();
+			emit(APPLY, site(message, NULL, 0));
+			
+			for (ExitsT::iterator exit = exits.begin(); exit != exits.end(); ++exit) {
+				_code->_instructions[*exit].a = here();
+			}
+		}
+		
+		void Compiler::compile(Object * expression, bool tail) {
+			Symbol * symbol = ptr(expression).as<Symbol>();
+			Cell * cell = ptr(expression).as<Cell>();
+			
+			if (cell) {
+				compile_message(cell, tail);
+				
+				return;
+			}
+			
+			if (expression == NULL) {
+				emit(CONSTANT, constant(NULL));
+			} else if (symbol && ptr(symbol).as<LexicalSymbol>()) {
+				emit(LEXICAL, constant(symbol));
+			} else if (symbol && symbol->value()[0] == ':') {
+				emit(CONSTANT, constant(symbol));
+			} else if (symbol) {
+				emit(LOOKUP, constant(symbol));
+			} else {
+				emit(EVALUATE, constant(expression));
+			}
+			
+			push();
+		}
+		
+		void Compiler::compile_message(Cell * message, bool tail) {
+			Symbol * name = message->head().as<Symbol>();
+			
+			// A lambda argument could have the same name as a builtin:
+			if (name && !ptr(name).as<LexicalSymbol>()) {
+				const StringT & value = name->value();
+				
+				if (value == "if" && compile_if(message, tail)) return;
+				if (value == "block" && compile_block(message, tail)) return;
+				if (value == "return" && compile_return(message)) return;
+				if (value == "or" && compile_or(message)) return;
+				if (value == "and" && compile_and(message)) return;
+				if (value == "value" && compile_value(message)) return;
+				if (value == "call" && compile_call(message, tail)) return;
+			}
+			
+			compile_application(message, tail);
+		}
+		
+		void Compiler::compile_application(Cell * message, bool tail) {
+			compile(message->head(), false);
+			
+			uint32_t count = 0;
+			
+			for (Cell * operand = message->tail().as<Cell>(); operand != NULL; operand = operand->tail().as<Cell>()) {
+				count += 1;
+			}
+			
+			uint32_t index = site(message, NULL, count);
+			uint32_t dispatch = emit(DISPATCH, index);
+			
+			_code->_sites[index].entry = here();
+			_code->_sites[index].depth = _depth;
+			
+			for (Cell * operand = message->tail().as<Cell>(); operand != NULL; operand = operand->tail().as<Cell>()) {
+				compile(operand->head(), false);
+			}
+			
+			_code->_sites[index].stop = here();
+			
+			emit(tail && _body ? TAIL_INVOKE : INVOKE, index);
+			pop(count);
+			
+			uint32_t done = emit(JUMP);
+			
+			// The function isn't a lambda which evaluates its arguments, so the message is applied by the evaluator:
+			_code->_instructions[dispatch].b = here();
+			emit(APPLY, index);
+			
+			_code->_instructions[done].a = here();
+		}
+		
+		bool Compiler::compile_if(Cell * message, bool tail) {
+			Cell * operands = message->tail().as<Cell>();
+			
+			if (!operands || !operands->head())
+				return false;
+			
+			Cell * clauses = operands->tail().as<Cell>();
+			Object * true_clause = clauses ? clauses->head().get() : NULL;
+			
+			Cell * otherwise = clauses ? clauses->tail().as<Cell>() : NULL;
+			Object * false_clause = otherwise ? otherwise->head().get() : NULL;
+			
+			ExitsT exits;
+			std::size_t base = _depth;
+			uint32_t check = guard(message, KAI_BUILTIN_FUNCTION(Logic::if_));
+			
+			compile(operands->head(), false);
+			uint32_t branch = emit(BRANCH);
+			pop();
+			
+			compile(true_clause, tail);
+			exits.push_back(emit(JUMP));
+			
+			_depth = base;
+			_code->_instructions[branch].a = here();
+			compile(false_clause, tail);
+			
+			fallback(check, message, exits);
+			
+			return true;
+		}
+		
+		bool Compiler::compile_block(Cell * message, bool tail) {
+			ExitsT exits;
+			std::size_t base = _depth;
+			uint32_t check = guard(message, KAI_BUILTIN_FUNCTION(Logic::block));
+			
+			uint32_t handler = _handler;
+			_handler = _labels.size();
+			_labels.push_back(NONE);
+			
+			Cell * statements = message->tail().as<Cell>();
+			
+			if (!statements) {
+				emit(CONSTANT, constant(NULL));
+				push();
+			}
+			
+			while (statements) {
+				Cell * next = statements->tail().as<Cell>();
+				
+				if (next) {
+					compile(statements->head(), false);
+					emit(POP);
+					pop();
+				} else {
+					compile(statements->head(), tail);
+				}
+				
+				statements = next;
+			}
+			
+			exits.push_back(emit(JUMP));
+			
+			// A return from any of the statements is completed here:
+			_labels[_handler] = here();
+			_depth = base;
+			emit(COMPLETE, base);
+			push();
+			
+			_handler = handler;
+			fallback(check, message, exits);
+			
+			return true;
+		}
+		
+		bool Compiler::compile_return(Cell * message) {
+			Cell * operands = message->tail().as<Cell>();
+			
+			// All operands are evaluated, so only the simple case is compiled:
+			if (operands && operands->tail())
+				return false;
+			
+			ExitsT exits;
+			uint32_t check = guard(message, KAI_BUILTIN_FUNCTION(Logic::return_));
+			
+			compile(operands ? operands->head().get() : NULL, false);
+			emit(RETURN, _handler);
+			
+			fallback(check, message, exits);
+			
+			return true;
+		}
+		
+		bool Compiler::compile_or(Cell * message) {
+			ExitsT exits;
+			uint32_t check = guard(message, KAI_BUILTIN_FUNCTION(Logic::or_));
+			
+			for (Cell * operand = message->tail().as<Cell>(); operand != NULL; operand = operand->tail().as<Cell>()) {
+				compile(operand->head(), false);
+				exits.push_back(emit(OR));
+				pop();
+			}
+			
+			emit(CONSTANT, constant(Symbol::false_symbol(_frame)));
+			push();
+			
+			fallback(check, message, exits);
+			
+			return true;
+		}
+		
+		bool Compiler::compile_and(Cell * message) {
+			ExitsT exits, failures;
+			std::size_t base = _depth;
+			uint32_t check = guard(message, KAI_BUILTIN_FUNCTION(Logic::and_));
+			
+			for (Cell * operand = message->tail().as<Cell>(); operand != NULL; operand = operand->tail().as<Cell>()) {
+				compile(operand->head(), false);
+				failures.push_back(emit(BRANCH));
+				pop();
+			}
+			
+			emit(CONSTANT, constant(Symbol::true_symbol(_frame)));
+			push();
+			exits.push_back(emit(JUMP));
+			
+			for (ExitsT::iterator failure = failures.begin(); failure != failures.end(); ++failure) {
+				_code->_instructions[*failure].a = here();
+			}
+			
+			_depth = base;
+			emit(CONSTANT, constant(Symbol::false_symbol(_frame)));
+			push();
+			
+			fallback(check, message, exits);
+			
+			return true;
+		}
+		
+		bool Compiler::compile_value(Cell * message) {
+			Cell * operands = message->tail().as<Cell>();
+			
+			ExitsT exits;
+			uint32_t check = guard(message, KAI_BUILTIN_FUNCTION(Object::value));
+			
+			emit(CONSTANT, constant(operands ? operands->head().get() : NULL));
+			push();
+			
+			fallback(check, message, exits);
+			
+			return true;
+		}
+		
+		bool Compiler::compile_call(Cell * message, bool tail) {
+			// [receiver name operands...] is parsed as (call receiver `(name operands...)):
+			Cell * operands = message->tail().as<Cell>();
+			Cell * rest = operands ? operands->tail().as<Cell>() : NULL;
+			
+			if (!rest || rest->tail())
+				return false;
+			
+			Cell * quote = rest->head().as<Cell>();
+			Symbol * value = quote ? quote->head().as<Symbol>() : NULL;
+			
+			if (!value || ptr(value).as<LexicalSymbol>() || value->value() != "value")
+				return false;
+			
+			Cell * quoted = quote->tail().as<Cell>();
+			Cell * body = quoted ? quoted->head().as<Cell>() : NULL;
+			Symbol * name = body ? body->head().as<Symbol>() : NULL;
+			
+			if (!name || name->value()[0] == ':')
+				return false;
+			
+			uint32_t count = 0;
+			
+			for (Cell * operand = body->tail().as<Cell>(); operand != NULL; operand = operand->tail().as<Cell>()) {
+				count += 1;
+			}
+			
+			ExitsT exits;
+			std::size_t base = _depth;
+			uint32_t check = guard(message, KAI_BUILTIN_FUNCTION(Object::call));
+			
+			compile(operands->head(), false);
+			
+			emit(LOOKUP, constant(value));
+			push();
+			uint32_t quote_check = emit(GUARD, constant(KAI_BUILTIN_FUNCTION(Object::value)));
+			pop();
+			
+			// The receiver is the first argument:
+			uint32_t index = site(body, name, count + 1);
+			uint32_t method = emit(METHOD, index);
+			push();
+			
+			_code->_sites[index].entry = here();
+			_code->_sites[index].depth = _depth;
+			
+			for (Cell * operand = body->tail().as<Cell>(); operand != NULL; operand = operand->tail().as<Cell>()) {
+				compile(operand->head(), false);
+			}
+			
+			_code->_sites[index].stop = here();
+			
+			emit(tail && _body ? TAIL_INVOKE : INVOKE, index);
+			pop(count + 1);
+			exits.push_back(emit(JUMP));
+			
+			// The method isn't a lambda which evaluates its arguments, so it is applied by the evaluator:
+			_depth = base + 2;
+			_code->_instructions[method].b = here();
+			emit(SEND, index);
+			pop();
+			exits.push_back(emit(JUMP));
+			
+			// The quote doesn't refer to the builtin, so the body is evaluated and sent as Object::call would:
+			_depth = base + 2;
+			_code->_instructions[quote_check].b = here();
+			emit(APPLY, site(quote, NULL, 0));
+			emit(CALL, index);
+			pop();
+			
+			fallback(check, message, exits);
+			
+			return true;
+		}
+		
+		void Compiler::link() {
+			Code::SitesT & sites = _code->_sites;
+			
+			for (Code::SitesT::iterator site = sites.begin(); site != sites.end(); ++site) {
+				if (site->handler != NONE)
+					site->handler = _labels[site->handler];
+			}
+			
+			Code::InstructionsT & instructions = _code->_instructions;
+			
+			for (Code::InstructionsT::iterator instruction = instructions.begin(); instruction != instructions.end(); ++instruction) {
+				if (instruction->operation == RETURN && instruction->a != NONE)
+					instruction->a = _labels[instruction->a];
+			}
+		}
+		
+		Code * Compiler::compile(Frame * frame, Object * expression, bool body) {
+			Code * code = new(frame) Code(expression);
+			
+			Compiler compiler(frame, code, body);
+			compiler.compile(expression, true);
+			compiler.link();
+			
+			return code;
+		}
+		
+		Ref<Object> Compiler::compile(Frame * frame) {
+			Object * value;
+			
+			frame->extract()(value, "value");
+			
+			Lambda * lambda = ptr(value).as<Lambda>();
+			
+			if (lambda) {
+				if (!lambda->compiled())
+					lambda->set_compiled(compile(frame, lambda->body(), true));
+				
+				return lambda;
+			}
+			
+			return compile(frame, value);
+		}
+		
+		Ref<Object> Compiler::disassemble(Frame * frame) {
+			Object * value;
+			
+			frame->extract()(value, "value");
+			
+			Code * code = ptr(value).as<Code>();
+			Lambda * lambda = ptr(value).as<Lambda>();
+			
+			if (lambda)
+				code = lambda->compiled();
+			
+			if (!code)
+				throw Exception("Not Compiled", value, frame);
+			
+			StringStreamT buffer;
+			code->disassemble(frame, buffer);
+			
+			return new(frame) String(buffer.str());
+		}
+		
+		void Compiler::import(Frame * frame) {
+			frame->update(frame->sym("compile"), KAI_BUILTIN_FUNCTION(Compiler::compile));
+			frame->update(frame->sym("disassemble"), KAI_BUILTIN_FUNCTION(Compiler::disassemble));
+		}
+		
+	}
+}
@@ -0,0 +1,92 @@
+//
+//  Compiler.h
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#ifndef _KAI_BYTECODE_COMPILER_H
+#define _KAI_BYTECODE_COMPILER_H
+
+#include "Code.hpp"
+
+namespace Kai {
+	
+	class Cell;
+	class Frame;
+	
+	namespace Bytecode {
+		
+		/** Lowers parsed expressions into Code for the Machine.
+		
+		 The meaning of a message depends on the value of its function at run time, so nothing is assumed about it. If the function turns out to be a lambda which evaluates its arguments, the compiled operands are evaluated directly onto the stack. Otherwise, the message is applied as the evaluator would, and the compiled operands are only used if the function unwraps its arguments; macros and builtins which inspect their operands get the original message.
+		
+		 The builtin special forms (if, block, return, and, or, value and method calls) are compiled inline, guarded by a check that the name still refers to the builtin.
+		 */
+		class Compiler {
+		protected:
+			Frame * _frame;
+			Code * _code;
+			
+			/// True if compiling the body of a lambda, in which case calls in tail position may replace the activation.
+			bool _body;
+			
+			/// The current stack depth.
+			std::size_t _depth;
+			
+			/// The label of the enclosing block, which completes pending returns.
+			uint32_t _handler;
+			std::vector<uint32_t> _labels;
+			
+			typedef std::vector<uint32_t> ExitsT;
+			
+			uint32_t constant(Object * value);
+			uint32_t site(Cell * message, Symbol * name, uint32_t count);
+			
+			uint32_t emit(Operation operation, uint32_t a = 0, uint32_t b = 0);
+			uint32_t here() const;
+			
+			void push(std::size_t count = 1);
+			void pop(std::size_t count = 1);
+			
+			/// Look up the function of the message, and check that it is the given builtin. Returns the guard, which is linked to the fallback.
+			uint32_t guard(Cell * message, Object * builtin);
+			
+			/// If the guard fails, the message is applied by the evaluator. The exits jump past the fallback.
+			void fallback(uint32_t guard, Cell * message, ExitsT & exits);
+			
+			void compile(Object * expression, bool tail);
+			void compile_message(Cell * message, bool tail);
+			void compile_application(Cell * message, bool tail);
+			
+			bool compile_if(Cell * message, bool tail);
+			bool compile_block(Cell * message, bool tail);
+			bool compile_return(Cell * message);
+			bool compile_or(Cell * message);
+			bool compile_and(Cell * message);
+			bool compile_value(Cell * message);
+			bool compile_call(Cell * message, bool tail);
+			
+			/// Resolve handler labels to instructions.
+			void link();
+			
+		public:
+			Compiler(Frame * frame, Code * code, bool body);
+			
+			/// Compile the given expression. If it is the body of a lambda, calls in tail position replace the activation of the lambda.
+			static Code * compile(Frame * frame, Object * expression, bool body = false);
+			
+			/// Compile the body of a lambda, returning the lambda, or compile an expression, returning the code.
+			static Ref<Object> compile(Frame * frame);
+			
+			/// Print the instructions of compiled code, or of a compiled lambda.
+			static Ref<Object> disassemble(Frame * frame);
+			
+			static void import(Frame * frame);
+		};
+		
+	}
+}
+
+#endif
@@ -0,0 +1,345 @@
+//
+//  Machine.cpp
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#include "Machine.hpp"
+#include "../Frame.hpp"
+#include "../Cell.hpp"
+#include "../Symbol.hpp"
+#include "../Array.hpp"
+#include "../Logic.hpp"
+#include "../Exception.hpp"
+
+#include <new>
+
+namespace Kai {
+	namespace Bytecode {
+		
+		/// Evaluates the compiled operands of a message which is applied by the evaluator, if the function unwraps its arguments.
+		class CompiledOperands : public OperandEvaluator {
+		protected:
+			Code * _code;
+			const Site & _site;
+			Object * _receiver;
+			
+		public:
+			CompiledOperands(Code * code, const Site & site, Object * receiver = NULL) : _code(code), _site(site), _receiver(receiver) {
+			}
+			
+			virtual ~CompiledOperands() {
+			}
+			
+			virtual void unwrap(Frame * frame) {
+				Machine::arguments(frame, _code, _site, _receiver);
+			}
+		};
+		
+		/// Returns the function if it is a lambda which evaluates its operands as arguments, and can be called with the given number of them. Macros and lambdas which refer to their caller are applied by the evaluator.
+		static Lambda * strict_lambda(Object * function, std::size_t count) {
+			Lambda * lambda = ptr(function).as<Lambda>();
+			
+			if (lambda && !lambda->is_macro() && !lambda->is_reflective() && lambda->arity() <= count)
+				return lambda;
+			
+			return NULL;
+		}
+		
+		Machine::Machine(Frame * frame, Code * code) : _frame(frame), _code(code), _stack(_inline_stack), _begin(0), _end(0), _activation(NULL), _returns(false) {
+			_activations[0].active = false;
+			_activations[1].active = false;
+			
+			reserve(code->depth());
+		}
+		
+		Machine::~Machine() {
+			_activations[0].release();
+			_activations[1].release();
+		}
+		
+		void Machine::reserve(std::size_t depth) {
+			if (depth > INLINE_STACK && depth > _overflow_stack.size()) {
+				_overflow_stack.resize(depth);
+				_stack = _overflow_stack.data();
+			}
+		}
+		
+		bool Machine::unwind(uint32_t handler, uint32_t & pc) const {
+			if (handler != NONE && handler >= _begin && handler < _end) {
+				pc = handler;
+				
+				return true;
+			}
+			
+			return false;
+		}
+		
+		bool Machine::replace(Lambda * lambda, Object ** arguments, std::size_t count) {
+			Code * code = lambda->compiled();
+			Locals * current = ptr(_frame->local_scope()).as<Locals>();
+			
+			// The current lambda scope is replaced on the dynamic scope chain, so both lambdas must use the same one:
+			if (!code || !current || current->lambda()->dynamic_scope_chain() != lambda->dynamic_scope_chain())
+				return false;
+			
+			lambda->profile(_frame, true);
+			
+			// If the lambda was promoted to native code, it is called instead:
+			if (lambda->native())
+				return false;
+			
+			Trampoline::Activation * activation = (_activation == &_activations[0]) ? &_activations[1] : &_activations[0];
+			
+			// The callee returns directly to the caller of the activation which is being replaced:
+			Locals * locals = ::new(activation->locals) Locals(lambda, current->frame(), true);
+			locals->bind(arguments, count);
+			
+			TransientFrame * frame = ::new(activation->frame) TransientFrame(locals, lambda->scope());
+			activation->active = true;
+			
+			Array * chain = lambda->dynamic_scope_chain();
+			
+			if (chain)
+				chain->value().back() = frame;
+			
+			if (_activation)
+				_activation->release();
+			
+			_activation = activation;
+			_frame = frame;
+			_code = code;
+			
+			reserve(code->depth());
+			
+			return true;
+		}
+		
+		Object ** Machine::execute(uint32_t begin, uint32_t end, std::size_t depth) {
+			_begin = begin;
+			_end = end;
+			
+			const Instruction * instructions = _code->instructions().data();
+			Object * const * constants = _code->constants().data();
+			const Site * sites = _code->sites().data();
+			
+			Object ** top = _stack + depth;
+			uint32_t pc = begin;
+			
+			while (pc != _end) {
+				const Instruction & instruction = instructions[pc++];
+				
+				switch (instruction.operation) {
+					case CONSTANT:
+						*top++ = constants[instruction.a];
+						break;
+					
+					case EVALUATE:
+						*top++ = constants[instruction.a]->evaluate(_frame);
+						break;
+					
+					case LOOKUP:
+						*top++ = _frame->lookup(static_cast<Symbol *>(constants[instruction.a]));
+						break;
+					
+					case LEXICAL:
+						*top++ = static_cast<LexicalSymbol *>(constants[instruction.a])->evaluate(_frame);
+						break;
+					
+					case POP:
+						--top;
+						break;
+					
+					case JUMP:
+						pc = instruction.a;
+						break;
+					
+					case BRANCH:
+						--top;
+						
+						if (!Object::to_boolean(_frame, *top))
+							pc = instruction.a;
+						
+						break;
+					
+					case OR:
+						if (Object::to_boolean(_frame, top[-1]))
+							pc = instruction.a;
+						else
+							--top;
+						
+						break;
+					
+					case GUARD:
+						if (top[-1] == constants[instruction.a])
+							--top;
+						else
+							pc = instruction.b;
+						
+						break;
+					
+					case DISPATCH:
+						if (!strict_lambda(top[-1], sites[instruction.a].count))
+							pc = instruction.b;
+						
+						break;
+					
+					case INVOKE:
+					case TAIL_INVOKE: {
+						const Site & site = sites[instruction.a];
+						Object ** arguments = top - site.count;
+						Lambda * lambda = static_cast<Lambda *>(arguments[-1]);
+						
+						if (instruction.operation == TAIL_INVOKE && replace(lambda, arguments, site.count)) {
+							// If a block was replaced, its pending returns are completed when the callee finishes:
+							if (site.handler != NONE)
+								_returns = true;
+							
+							instructions = _code->instructions().data();
+							constants = _code->constants().data();
+							sites = _code->sites().data();
+							
+							_begin = 0;
+							_end = _code->instructions().size();
+							
+							top = _stack;
+							pc = 0;
+							
+							break;
+						}
+						
+						Ref<Object> result = lambda->call(_frame, arguments, site.count);
+						
+						top = arguments;
+						top[-1] = result;
+						
+						if (Return::pending() && !unwind(site.handler, pc))
+							return top;
+						
+						break;
+					}
+					
+					case APPLY: {
+						const Site & site = sites[instruction.a];
+						CompiledOperands operands(_code, site);
+						
+						Ref<Object> result = _frame->apply(top[-1], site.message, site.entry != NONE ? &operands : NULL);
+						
+						top[-1] = result;
+						
+						if (Return::pending() && !unwind(site.handler, pc))
+							return top;
+						
+						break;
+					}
+					
+					case METHOD: {
+						const Site & site = sites[instruction.a];
+						Object * receiver = top[-1];
+						
+						if (!receiver) {
+							throw ArgumentError("self", Object::NAME, NULL, _frame);
+						}
+						
+						// The method is looked up in the scope of the receiver, as Object::lookup does:
+						TransientFrame scope(receiver, _frame);
+						Ref<Object> method = scope.lookup(site.name);
+						
+						top[-1] = method;
+						*top++ = receiver;
+						
+						if (!strict_lambda(method, site.count))
+							pc = instruction.b;
+						
+						break;
+					}
+					
+					case SEND: {
+						const Site & site = sites[instruction.a];
+						Object * receiver = top[-1];
+						
+						// The message is constructed as Object::call would, in case the method inspects its operands:
+						Cell * operands = new(_frame) Cell(receiver->as_value(_frame), site.message->tail());
+						Cell * message = new(_frame) Cell(site.name, operands);
+						
+						CompiledOperands arguments(_code, site, receiver);
+						Ref<Object> result = _frame->apply(top[-2], message, &arguments);
+						
+						--top;
+						top[-1] = result;
+						
+						if (Return::pending() && !unwind(site.handler, pc))
+							return top;
+						
+						break;
+					}
+					
+					case CALL: {
+						const Site & site = sites[instruction.a];
+						Object * receiver = top[-2];
+						Cell * body = ptr(top[-1]).as<Cell>();
+						
+						if (!receiver) {
+							throw ArgumentError("self", Object::NAME, NULL, _frame);
+						}
+						
+						if (!body) {
+							throw ArgumentError("body", Cell::NAME, top[-1], _frame);
+						}
+						
+						Ref<Object> result = Object::send(_frame, receiver, body);
+						
+						--top;
+						top[-1] = result;
+						
+						if (Return::pending() && !unwind(site.handler, pc))
+							return top;
+						
+						break;
+					}
+					
+					case RETURN:
+						Return::request(top[-1]);
+						
+						if (!unwind(instruction.a, pc))
+							return top;
+						
+						break;
+					
+					case COMPLETE:
+						top = _stack + instruction.a;
+						*top++ = Return::complete();
+						break;
+				}
+			}
+			
+			return top;
+		}
+		
+		Ref<Object> Machine::run(Frame * frame, Code * code) {
+			Machine machine(frame, code);
+			
+			Object ** top = machine.execute(0, code->instructions().size(), 0);
+			Ref<Object> result = (top != machine._stack) ? top[-1] : NULL;
+			
+			// A block which was replaced by a tail call would have completed the return:
+			if (Return::pending() && machine._returns)
+				return Return::complete();
+			
+			return result;
+		}
+		
+		void Machine::arguments(Frame * frame, Code * code, const Site & site, Object * receiver) {
+			Machine machine(frame, code);
+			
+			// The operands are compiled relative to the values below them on the stack:
+			Object ** values = machine._stack + site.depth;
+			Object ** top = machine.execute(site.entry, site.stop, site.depth);
+			
+			frame->assign_arguments(values, top - values, receiver);
+		}
+		
+	}
+}
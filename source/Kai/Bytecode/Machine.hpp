@@ -0,0 +1,72 @@
+//
+//  Machine.h
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#ifndef _KAI_BYTECODE_MACHINE_H
+#define _KAI_BYTECODE_MACHINE_H
+
+#include "Code.hpp"
+#include "../Lambda.hpp"
+
+namespace Kai {
+	
+	class Cell;
+	class Frame;
+	
+	namespace Bytecode {
+		
+		/** Executes Code using a stack of values, which is allocated on the native stack along with the machine.
+		
+		 When the code is the body of a lambda, a lambda called in tail position replaces the activation and its code is executed by the same machine, so recursion between compiled lambdas runs in constant stack.
+		 */
+		class Machine {
+		protected:
+			/// Most code only needs a few values on the stack at once.
+			enum { INLINE_STACK = 32 };
+			
+			Frame * _frame;
+			Code * _code;
+			
+			Object ** _stack;
+			Object * _inline_stack[INLINE_STACK];
+			std::vector<Object *> _overflow_stack;
+			
+			/// The instructions being executed, so that the handler of a pending return can be checked.
+			uint32_t _begin, _end;
+			
+			Trampoline::Activation _activations[2];
+			Trampoline::Activation * _activation;
+			
+			/// True if a block was replaced by a tail call, in which case the machine completes any pending return.
+			bool _returns;
+			
+			void reserve(std::size_t depth);
+			
+			/// Continue at the handler of a pending return, if it is within the instructions being executed. Otherwise, returns false.
+			bool unwind(uint32_t handler, uint32_t & pc) const;
+			
+			/// Replace the current activation with the given lambda, if possible.
+			bool replace(Lambda * lambda, Object ** arguments, std::size_t count);
+			
+			/// Execute the instructions from begin up to but not including end, returning the top of the stack.
+			Object ** execute(uint32_t begin, uint32_t end, std::size_t depth);
+			
+		public:
+			Machine(Frame * frame, Code * code);
+			~Machine();
+			
+			/// Execute the given code in the given frame.
+			static Ref<Object> run(Frame * frame, Code * code);
+			
+			/// Evaluate the compiled operands of a site and store them as the arguments of the given frame, preceded by the receiver if given.
+			static void arguments(Frame * frame, Code * code, const Site & site, Object * receiver);
+		};
+		
+	}
+}
+
+#endif
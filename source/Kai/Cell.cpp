@@ -10,12 +10,13 @@
 #include "Frame.hpp"
 #include "Function.hpp"
 #include "Symbol.hpp"
+#include "Lambda.hpp"
 
 namespace Kai {
 	
 	const char * const Cell::NAME = "Cell";
 	
-	Cell::Cell(Object * head, Object * tail) : _head(head), _tail(tail) {
+	Cell::Cell(Object * head, Object * tail) : Object(CELL_TAG), _head(head), _tail(tail), _call_site() {
 		
 	}
 	
@@ -138,9 +139,51 @@ namespace Kai {
 	}
 	
 	Ref<Object> Cell::evaluate(Frame * frame) {
+		// A quoted value doesn't need a frame:
+		if (cached_function() == KAI_BUILTIN_FUNCTION(Object::value)) {
+			Cell * operands = ptr(_tail).as<Cell>();
+			
+			return operands ? operands->_head : NULL;
+		}
+		
 		return frame->call(NULL, this);
 	}
 	
+	Object * Cell::cached_function() const {
+		// Only symbols are cached:
+		if (_call_site.function && _call_site.generation == Bindings::generation(Bindings::bucket(static_cast<Symbol *>(_head))))
+			return _call_site.function;
+		
+		return NULL;
+	}
+	
+	Ref<Object> Cell::function(Frame * frame) {
+		Object * function = cached_function();
+		
+		if (function)
+			return function;
+		
+		Symbol * name = ptr(_head).as<Symbol>();
+		
+		// Lexical symbols depend on the frame, and keywords evaluate to themselves:
+		if (!name || ptr(_head).as<LexicalSymbol>() || name->value()[0] == ':')
+			return _head->evaluate(frame);
+		
+		std::size_t bucket = Bindings::bucket(name);
+		Bindings::GenerationT generation = Bindings::generation(bucket);
+		
+		Frame * scope = NULL;
+		Ref<Object> result = frame->lookup(name, scope);
+		
+		// If every binding of the name has the same value, and it was found in the global scope, every frame will find the same function:
+		if (scope->top() && Bindings::unique(bucket, result)) {
+			_call_site.function = result;
+			_call_site.generation = generation;
+		}
+		
+		return result;
+	}
+	
 	Ref<Object> Cell::new_(Frame * frame) {
 		Object * self, * head = NULL, * tail = NULL;
 		
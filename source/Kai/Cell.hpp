@@ -13,6 +13,7 @@
 #include "Table.hpp"
 #include "Exception.hpp"
 #include "Frame.hpp"
+#include "Symbol.hpp"
 
 namespace Kai {
 	
@@ -23,6 +24,20 @@ namespace Kai {
 		Object * _head;
 		Object * _tail;
 		
+		/** When the cell is a message, the function named by its head is cached once it has been found in the global scope, provided every binding of the name has the same value. The function is used until any binding in the same bucket changes, so the head isn't looked up again, and quoted values are returned without applying the builtin.
+		 
+		 The function isn't marked, since it remains reachable from its binding for as long as the cache is valid.
+		 */
+		struct CallSite {
+			Object * function;
+			Bindings::GenerationT generation;
+		};
+		
+		CallSite _call_site;
+		
+		/// Returns the cached function, or NULL if there isn't one.
+		Object * cached_function() const;
+		
 	public:
 		static const char * const NAME;
 		
@@ -33,11 +48,12 @@ namespace Kai {
 		
 		virtual void mark(Memory::Traversal *) const;
 		
-		Ref<Object> head() { return _head; }
-		const Ref<Object> head() const { return _head; }
+		// The cell owns its head and tail, so they are borrowed rather than retained:
+		Borrowed<Object> head() { return _head; }
+		const Borrowed<Object> head() const { return _head; }
 		
-		Ref<Object> tail() { return _tail; }
-		const Ref<Object> tail() const { return _tail; }
+		Borrowed<Object> tail() { return _tail; }
+		const Borrowed<Object> tail() const { return _tail; }
 		
 		Cell * insert(Object * object);
 		Cell * append(Object * object);
@@ -60,6 +76,9 @@ namespace Kai {
 		
 		virtual Ref<Object> evaluate(Frame * frame);
 		
+		/// Evaluate the head of the message, using the cached function if possible.
+		Ref<Object> function(Frame * frame);
+		
 		ArgumentExtractor extract(Frame * frame);
 		
 		class ListBuilder {
@@ -104,12 +123,51 @@ namespace Kai {
 	
 // MARK: -
 	
+	/** Extracts arguments in order, either from a list of operands or from the evaluated arguments of a frame, which are stored contiguously.
+	 
+	 Evaluated arguments can also be extracted by index, e.g. arguments.at(integer, 1, "right-value").
+	 */
 	class ArgumentExtractor {
 		Frame * _frame;
 		Cell * _current;
+		Object ** _next, ** _end;
+		
+		inline ArgumentExtractor(Frame * frame, Cell * current, Object ** next, Object ** end) : _frame(frame), _current(current), _next(next), _end(end) {
+			
+		}
+		
+		inline bool empty() const {
+			return _current == NULL && _next == _end;
+		}
+		
+		inline Object * head() const {
+			if (_current)
+				return _current->head();
+			else
+				return *_next;
+		}
+		
+		inline ArgumentExtractor tail() const {
+			if (_current)
+				return ArgumentExtractor(_frame, _current->tail().as<Cell>(), _next, _end);
+			else
+				return ArgumentExtractor(_frame, NULL, _next + 1, _end);
+		}
+		
+		template <typename AnyT>
+		static void check(AnyT * t, Object * value, const StringT & name, bool required, Frame * frame) {
+			// If t is true or wasn't required, everything is okay.
+			if (!t && required) {
+				throw ArgumentError(name, AnyT::NAME, value, frame);
+			}
+		}
 		
 	public:
-		inline ArgumentExtractor(Frame * frame, Cell * current) : _frame(frame), _current(current) {
+		inline ArgumentExtractor(Frame * frame, Cell * current) : _frame(frame), _current(current), _next(NULL), _end(NULL) {
+			
+		}
+		
+		inline ArgumentExtractor(Frame * frame, Object ** begin, Object ** end) : _frame(frame), _current(NULL), _next(begin), _end(end) {
 			
 		}
 		
@@ -117,37 +175,29 @@ namespace Kai {
 		template <typename AnyT>
 		ArgumentExtractor operator[](AnyT *& t) {
 			// We have an empty argument list.
-			if (_current == NULL) {
+			if (empty()) {
 				t = NULL;
 				return *this;
 				//throw Exception("Argument Error", _frame);
 			}
 			
-			t = _current->head().as<AnyT>();
+			t = ptr(head()).as<AnyT>();
 			
-			return ArgumentExtractor(_frame, _current->tail().as<Cell>());
+			return tail();
 		}
 		
 		// Ensures argument is non-NULL
 		template <typename AnyT>
 		ArgumentExtractor operator()(AnyT *& t, const StringT & name, bool required = true) {
-			if (_current == NULL) {
+			if (empty()) {
 				throw ArgumentError(name, AnyT::NAME, NULL, _frame);
 			}
 			
-			t = _current->head().as<AnyT>();
+			t = ptr(head()).as<AnyT>();
 			
-			// If t is true or wasn't required, everything is okay.
-			if (t || !required) {
-				return ArgumentExtractor(_frame, _current->tail().as<Cell>());
-			}
+			check(t, head(), name, required, _frame);
 			
-			// Else, something went wrong:
-			if (_current->head()) {
-				throw ArgumentError(name, AnyT::NAME, _current->head(), _frame);
-			} else {
-				throw ArgumentError(name, AnyT::NAME, NULL, _frame);
-			}
+			return tail();
 		}
 		
 		// Ensures argument is non-NULL
@@ -156,8 +206,27 @@ namespace Kai {
 			return (*this)(t, "*unspecified*", true);
 		}
 		
-		inline operator Cell *() {
-			return _current;
+		/// The number of remaining evaluated arguments.
+		inline std::size_t size() const {
+			return _end - _next;
+		}
+		
+		/// Extract the evaluated argument at the given index, relative to the current one.
+		template <typename AnyT>
+		ArgumentExtractor & at(AnyT *& t, std::size_t index, const StringT & name, bool required = true) {
+			if (index >= size()) {
+				throw ArgumentError(name, AnyT::NAME, NULL, _frame);
+			}
+			
+			t = ptr(_next[index]).as<AnyT>();
+			
+			check(t, _next[index], name, required, _frame);
+			
+			return *this;
+		}
+		
+		inline operator bool() const {
+			return !empty();
 		}
 	};
 	
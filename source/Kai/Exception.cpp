@@ -14,11 +14,11 @@
 
 namespace Kai {
 	
-	Exception::Exception(StringT what, Frame * frame) : _what(what), _object(NULL), _frame(frame) {
+	Exception::Exception(StringT what, Frame * frame) : _what(what), _object(NULL), _frame(frame ? frame->promote() : NULL) {
 		
 	}
 	
-	Exception::Exception(StringT what, Object * object, Frame * frame) : _what(what), _object(object), _frame(frame) {
+	Exception::Exception(StringT what, Object * object, Frame * frame) : _what(what), _object(object), _frame(frame ? frame->promote() : NULL) {
 		
 	}
 	
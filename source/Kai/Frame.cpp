@@ -14,8 +14,12 @@
 #include "Number.hpp"
 #include "String.hpp"
 #include "Symbol.hpp"
+#include "Lambda.hpp"
+#include "Logic.hpp"
 #include "SourceCode.hpp"
 
+#include <algorithm>
+
 //#define KAI_DEBUG
 
 namespace Kai {
@@ -114,13 +118,16 @@ namespace Kai {
 	
 // MARK: -
 	
+	OperandEvaluator::~OperandEvaluator() {
+	}
+	
 	const char * const Frame::NAME = "Frame";
 	
-	Frame::Frame(Object * scope) : _previous(NULL), _scope(scope), _message(NULL), _function(NULL), _arguments(NULL), _depth(0) {
+	Frame::Frame(Object * scope) : Object(FRAME_TAG), _previous(NULL), _scope(scope), _message(NULL), _function(NULL), _values(NULL), _count(0), _overflow_values(NULL), _arguments(NULL), _depth(0), _transient(false), _promoted(NULL), _trampoline(NULL), _operand_evaluator(NULL) {
 		_allocator = this->ObjectAllocation::allocator();
 	}
 	
-	Frame::Frame(Object * scope, Frame * previous) : _previous(previous), _scope(scope), _message(previous->_message), _function(previous->_function), _arguments(previous->_arguments)
+	Frame::Frame(Object * scope, Frame * previous) : Object(FRAME_TAG), _previous(previous), _scope(scope), _message(previous->_message), _function(previous->_function), _values(previous->_values), _count(previous->_count), _overflow_values(NULL), _arguments(previous->_arguments), _transient(false), _promoted(NULL), _trampoline(NULL), _operand_evaluator(NULL)
 	{
 		_allocator = previous->allocator();
 		
@@ -130,7 +137,7 @@ namespace Kai {
 #endif
 	}
 	
-	Frame::Frame(Object * scope, Cell * message, Frame * previous) : _previous(previous), _scope(scope), _message(message), _function(NULL), _arguments(NULL) {
+	Frame::Frame(Object * scope, Cell * message, Frame * previous) : Object(FRAME_TAG), _previous(previous), _scope(scope), _message(message), _function(NULL), _values(NULL), _count(0), _overflow_values(NULL), _arguments(NULL), _transient(false), _promoted(NULL), _trampoline(NULL), _operand_evaluator(NULL) {
 		_allocator = previous->_allocator;
 		
 		_depth = _previous->_depth + 1;
@@ -141,6 +148,32 @@ namespace Kai {
 	}
 	
 	Frame::~Frame() {
+		delete[] _overflow_values;
+	}
+	
+	Frame * Frame::promote() {
+		if (!_transient) return this;
+		
+		if (!_promoted) {
+			Object * scope = _scope;
+			Locals * locals = ptr(scope).as<Locals>();
+			
+			// The locals are shared between the transient frame and the copy, so that updates are visible to both:
+			if (locals) {
+				scope = locals->promote();
+			}
+			
+			_promoted = new(_allocator) Frame(scope, _message, _previous->promote());
+			_promoted->_function = _function;
+			
+			// The arguments may be stored by a transient frame, so the copy needs its own:
+			if (_values)
+				_promoted->assign_arguments(_values, _count);
+			
+			_promoted->_arguments = _arguments;
+		}
+		
+		return _promoted;
 	}
 	
 	Ref<Symbol> Frame::identity(Frame * frame) const {
@@ -160,8 +193,20 @@ namespace Kai {
 			lookup(identifier, frame);
 		}
 		
+		Locals * locals = ptr(frame->_scope).as<Locals>();
+		
+		if (locals) {
+			locals->update(identifier, value);
+			
+			return locals;
+		}
+		
 		Table * scope = ptr(frame->_scope).as<Table>();
 		
+		if (!scope) {
+			throw Exception("Non-table Scope", frame->_scope, this);
+		}
+		
 		// Potentially use an interface for this operation, rather than hard coding Table.
 		scope->update(identifier, value);
 		
@@ -173,6 +218,11 @@ namespace Kai {
 		traversal->traverse(_scope);
 		traversal->traverse(_message);
 		traversal->traverse(_function);
+		
+		for (std::size_t i = 0; _values && i < _count; i += 1) {
+			traversal->traverse(_values[i]);
+		}
+		
 		traversal->traverse(_arguments);
 	}
 	
@@ -201,23 +251,29 @@ namespace Kai {
 		return this->lookup(identifier);
 	}
 	
-	Ref<Object> Frame::apply() {
+	Ref<Object> Frame::invoke() {
 #ifdef KAI_DEBUG
 		std::cerr << "-- " << Object::to_string(this, _message) << " <= " << Object::to_string(this, _scope) << std::endl;
 		std::cerr << StringT(_depth, '\t') << "Fetching Function " << Object::to_string(this, _message->head()) << std::endl;
 #endif
 		
-		_function = _message->head()->evaluate(this);
+		// The function may have already been evaluated, e.g. by compiled code:
+		if (!_function) {
+			_function = _message->function(this);
+			
+			if (Return::pending())
+				return _function;
+			
+			if (!_function) {
+				throw Exception("Invalid Function", _message->head(), this);
+			}
+		}
 		
 #ifdef KAI_DEBUG
 		std::cerr << StringT(_depth, '\t') << "Executing Function " << Object::to_string(this, _function) << std::endl;		
 		this->debug(true);
 #endif
 		
-		if (!_function) {
-			throw Exception("Invalid Function", _message->head(), this);
-		}
-		
 #ifdef KAI_TRACE
 		// trace will be deconstructed even in the event of an exception.
 		Trace trace(this);
@@ -226,20 +282,76 @@ namespace Kai {
 		return _function->evaluate(this);
 	}
 	
+	Ref<Object> Frame::apply() {
+		Trampoline trampoline(this);
+		Frame * frame = this;
+		
+		while (true) {
+			Ref<Object> result = frame->invoke();
+			
+			if (Return::pending()) {
+				// A block which was replaced by a tail call would have completed the return:
+				if (trampoline.returns())
+					return Return::complete();
+				
+				// Otherwise, any tail call is abandoned, and the return continues to unwind:
+				return result;
+			}
+			
+			frame = trampoline.next();
+			
+			if (!frame) return result;
+		}
+	}
+	
+	Ref<Object> Frame::tail(Object * expression, bool block) {
+		Cell * message = ptr(expression).as<Cell>();
+		
+		if (message && _trampoline && _trampoline->current() == this) {
+			_message = message;
+			_function = NULL;
+			_values = NULL;
+			_count = 0;
+			_arguments = NULL;
+			_operand_evaluator = NULL;
+			
+			_trampoline->tail_call(this, block);
+			
+			return NULL;
+		}
+		
+		if (expression)
+			return expression->evaluate(this);
+		else
+			return NULL;
+	}
+	
 	Ref<Object> Frame::call(Object * scope, Cell * message) {
 		if (message == NULL) {
 			throw Exception("Invalid Message", this);
 		}
 		
-		Ref<Frame> frame = new(this) Frame(scope, message, this);
+		TransientFrame frame(scope, message, this);
 		
 #ifdef KAI_DEBUG
-		std::cerr << "Stack pointer: " << (void*)&frame << std::endl;
-		std::cerr << "Allocating new frame at address " << frame << " from frame " << this << " in scope " << scope << " with message " << message << std::endl;
-		frame->debug(false);
+		std::cerr << "Allocating new frame at address " << &frame << " from frame " << this << " in scope " << scope << " with message " << message << std::endl;
+		frame.debug(false);
 #endif
 		
-		return frame->apply();
+		return frame.apply();
+	}
+	
+	Ref<Object> Frame::apply(Object * function, Cell * message, OperandEvaluator * operands) {
+		if (!function) {
+			throw Exception("Invalid Function", message ? message->head().get() : NULL, this);
+		}
+		
+		TransientFrame frame(NULL, message, this);
+		
+		frame._function = function;
+		frame._operand_evaluator = operands;
+		
+		return frame.apply();
 	}
 	
 	Cell * Frame::message() {
@@ -263,6 +375,12 @@ namespace Kai {
 			}
 		}
 		
+		Locals * locals = scope.as<Locals>();
+		
+		if (locals) {
+			return locals->table();
+		}
+		
 		return scope;
 	}
 	
@@ -277,33 +395,92 @@ namespace Kai {
 			return NULL;
 	}
 	
-	// With optimisations turned on, this function seems to cause stack frames to be reused and cause problems..!?
-	Cell * Frame::unwrap() {
-#ifdef KAI_DEBUG
-		std::cerr << "Unwrapping with frame: " << this << std::endl;
-#endif
-		if (_arguments) return _arguments;
+	Object ** Frame::allocate_arguments(std::size_t count) {
+		if (count <= INLINE_ARGUMENTS)
+			return _inline_values;
+		
+		delete[] _overflow_values;
+		_overflow_values = new Object * [count];
+		
+		return _overflow_values;
+	}
+	
+	std::size_t Frame::evaluate_arguments() {
+		if (_values) return _count;
+		
+		if (_operand_evaluator) {
+			_operand_evaluator->unwrap(this);
+			
+			return _count;
+		}
+		
+		std::size_t count = 0;
+		
+		for (Cell * cur = operands(); cur != NULL; cur = cur->tail().as<Cell>()) {
+			count += 1;
+		}
 		
-		Cell * last = NULL;
-		Cell * cur = operands();
+		// The arguments are only stored once they have all been evaluated:
+		Object ** values = allocate_arguments(count);
+		std::size_t index = 0;
 		
-		while (cur) {
+		for (Cell * cur = operands(); cur != NULL; cur = cur->tail().as<Cell>()) {
 			Ref<Object> value = NULL;
 			
 			// If cur->head() == NULL, the result is also NULL.
 			if (cur->head())
 				value = cur->head()->evaluate(this);
 			
-			last = Cell::append(this, last, value, _arguments);
+			values[index++] = value;
 			
-			cur = cur->tail().as<Cell>();
+			// The remaining operands are not evaluated once a return is pending:
+			if (Return::pending())
+				break;
+		}
+		
+		_values = values;
+		_count = index;
+		
+		return _count;
+	}
+	
+	void Frame::assign_arguments(Object * const * values, std::size_t count, Object * receiver) {
+		std::size_t offset = receiver ? 1 : 0;
+		Object ** storage = allocate_arguments(offset + count);
+		
+		if (receiver)
+			storage[0] = receiver;
+		
+		std::copy(values, values + count, storage + offset);
+		
+		_values = storage;
+		_count = offset + count;
+		_arguments = NULL;
+	}
+	
+	Cell * Frame::unwrap() {
+#ifdef KAI_DEBUG
+		std::cerr << "Unwrapping with frame: " << this << std::endl;
+#endif
+		evaluate_arguments();
+		
+		// The list is constructed from the evaluated arguments the first time it is needed:
+		if (!_arguments) {
+			Cell * last = NULL;
+			
+			for (std::size_t i = 0; i < _count; i += 1) {
+				last = Cell::append(this, last, _values[i], _arguments);
+			}
 		}
 		
 		return _arguments;
 	}
 	
 	Cell * Frame::arguments() {
-		return _arguments;
+		if (_values)
+			return unwrap();
+		else
+			return NULL;
 	}
 	
 	bool Frame::top() {
@@ -311,22 +488,13 @@ namespace Kai {
 	}
 	
 	ArgumentExtractor Frame::extract(bool evaluate) {
-		Cell * args = NULL;
-		
 		if (evaluate) {
-			args = unwrap();
+			evaluate_arguments();
+			
+			return ArgumentExtractor(this, _values, _values + _count);
 		} else {
-			args = operands();
+			return ArgumentExtractor(this, operands());
 		}
-		
-		// We don't need this as long as all arguments are optional.. otherwise, as expected, required arguments will cause an error.
-		//if (args == NULL) {
-		//	throw Exception("No arguments provided!", this);
-		// Dummy for extraction of null arguments.
-		//	args = new Cell(NULL, NULL);
-		//}
-		
-		return args->extract(this);
 	}
 	
 	void Frame::at(Object * object) {
@@ -405,7 +573,10 @@ namespace Kai {
 		Frame * location = NULL;
 		frame->lookup(identifier, location);
 		
-		return location;
+		if (location)
+			return location->promote();
+		else
+			return NULL;
 	}
 	
 	// Attempt to update inplace a value in a frame
@@ -420,14 +591,7 @@ namespace Kai {
 		frame->lookup(identifier, location);
 		
 		if (location) {
-			// TODO: Maybe improve the level of abstraction so we are not completely depenedent on Tables for scope.
-			Table * scope = ptr(location->scope()).as<Table>();
-			
-			if (scope) {
-				scope->update(identifier, new_value);
-			} else {
-				throw Exception("Non-table Scope", location->scope(), frame);
-			}
+			location->update(identifier, new_value, true);
 		} else {
 			throw Exception("Invalid Variable Name", identifier, frame);
 		}
@@ -549,21 +713,29 @@ namespace Kai {
 		}
 	}
 	
-	Ref<Object> Frame::with(Frame * frame) {
-		Cell * cur = frame->operands();
-		Ref<Object> scope = frame->scope();
-		Frame * next = frame;
+	// Each expression is evaluated in the scope of the previous one, using transient frames which only exist for the duration of the evaluation.
+	static Ref<Object> with_scope(Frame * frame, Cell * expressions) {
+		Ref<Object> scope = expressions->head()->evaluate(frame);
+		Cell * next = expressions->tail().as<Cell>();
 		
-		while (cur != NULL) {
-			scope = cur->head()->evaluate(next);
-			next = new(frame) Frame(scope, next);
+		if (next && !Return::pending()) {
+			TransientFrame transient_frame(scope, frame);
 			
-			cur = cur->tail().as<Cell>();
+			return with_scope(&transient_frame, next);
 		}
 		
 		return scope;
 	}
 	
+	Ref<Object> Frame::with(Frame * frame) {
+		Cell * expressions = frame->operands();
+		
+		if (expressions)
+			return with_scope(frame, expressions);
+		else
+			return frame->scope();
+	}
+	
 	Ref<Object> Frame::operands(Frame * frame) {
 		return frame->operands();
 	}
@@ -596,4 +768,26 @@ namespace Kai {
 	Symbol * Frame::sym(const char * name) {
 		return new(this) Symbol(name);
 	}
+	
+// MARK: -
+	
+	TransientFrame::TransientFrame(Object * scope, Frame * previous) : Frame(scope, previous) {
+		// This object wasn't allocated by a memory allocator, so it has no allocation meta-data:
+		_next = NULL;
+		_flags = 0;
+		_tag = TRANSIENT_FRAME_TAG;
+		
+		_transient = true;
+	}
+	
+	TransientFrame::TransientFrame(Object * scope, Cell * message, Frame * previous) : Frame(scope, message, previous) {
+		_next = NULL;
+		_flags = 0;
+		_tag = TRANSIENT_FRAME_TAG;
+		
+		_transient = true;
+	}
+	
+	TransientFrame::~TransientFrame() {
+	}
 }
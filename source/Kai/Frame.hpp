@@ -20,6 +20,17 @@ namespace Kai {
 	
 	class Cell;
 	class ArgumentExtractor;
+	class Trampoline;
+	class Frame;
+	
+	/// Evaluates the operands of a frame on behalf of Frame::evaluate_arguments, e.g. using compiled code. Anything which inspects the operands directly still gets the original message.
+	class OperandEvaluator {
+	public:
+		virtual ~OperandEvaluator();
+		
+		/// Evaluate the operands and store them using Frame::assign_arguments.
+		virtual void unwrap(Frame * frame) = 0;
+	};
 	
 	class Tracer : public Object {
 	protected:
@@ -59,6 +70,11 @@ namespace Kai {
 	 */
 	class Frame : public Object {
 	protected:
+		friend class Trampoline;
+		
+		/// Most functions take only a few arguments, which are stored in the frame itself.
+		enum { INLINE_ARGUMENTS = 4 };
+		
 		/// Cache the memory allocator for faster allocation.
 		Memory::PageAllocation * _allocator;
 		
@@ -74,17 +90,42 @@ namespace Kai {
 		/// The evaluated function.
 		Object * _function;
 		
-		/// The unwrapped arguments.
+		/// The evaluated arguments, or NULL if they haven't been evaluated. They may be stored by a previous frame.
+		Object ** _values;
+		std::size_t _count;
+		
+		Object * _inline_values[INLINE_ARGUMENTS];
+		Object ** _overflow_values;
+		
+		/// The evaluated arguments as a list, which is only constructed if requested.
 		Cell * _arguments;
 		
 		/// For debugging - the depth of the stack.
 		unsigned _depth;
 		
-		/// Given a stack frame, apply the function to the arguments.
+		/// True if the frame was allocated on the native stack rather than the heap.
+		bool _transient;
+		
+		/// If a transient frame is captured, this is the heap allocated copy.
+		Frame * _promoted;
+		
+		/// The trampoline which is currently applying this frame, if any.
+		Trampoline * _trampoline;
+		
+		/// If the operands have been compiled, this evaluates them in place of the message.
+		OperandEvaluator * _operand_evaluator;
+		
+		/// Evaluate the function and apply it to the arguments, once.
+		Ref<Object> invoke();
+		
+		/// Given a stack frame, apply the function to the arguments. Expressions in tail position are evaluated in a loop by the trampoline, rather than recursively.
 		Ref<Object> apply();
 		
 		void at(Object * object);
 		
+		/// Storage for the given number of arguments, which is either inline or owned by this frame.
+		Object ** allocate_arguments(std::size_t count);
+		
 	public:
 		static const char * const NAME;
 		
@@ -99,6 +140,19 @@ namespace Kai {
 		
 		virtual ~Frame();
 		
+		bool transient() const { return _transient; }
+		
+		Trampoline * trampoline() const { return _trampoline; }
+		
+		/// Apply a function which has already been evaluated to the given message, in a new transient frame. If given, the operand evaluator is used when the arguments are unwrapped.
+		Ref<Object> apply(Object * function, Cell * message, OperandEvaluator * operands = NULL);
+		
+		/// Evaluate an expression in tail position. If this frame is being applied by a trampoline and the expression is a message, the message replaces the current one and NULL is returned; the trampoline evaluates it once the current function returns. If the replaced function was a block, the trampoline takes over handling of return.
+		Ref<Object> tail(Object * expression, bool block = false);
+		
+		/// Transient frames only exist for the duration of a single evaluation. If a frame needs to be captured (e.g. by a closure, or an exception), this function returns a heap allocated copy of the frame and any transient frames above it. Otherwise, it returns this.
+		Frame * promote();
+		
 		virtual Ref<Symbol> identity(Frame * frame) const;
 		
 		virtual void mark(Memory::Traversal * traversal) const;
@@ -124,9 +178,12 @@ namespace Kai {
 		/// Return the previous stack frame.
 		Frame * previous();
 		
-		/// This function searches up the stack for the current scope.
+		/// This function searches up the stack for the current scope. If the scope is the locals of a lambda, it is materialised into a table.
 		Object * scope();
 		
+		/// The scope of this stack frame only, which may be NULL.
+		Object * local_scope() { return _scope; }
+		
 		/// Return the message (m o1 o2 o3) if it is defined.
 		Cell * message();
 		
@@ -136,12 +193,31 @@ namespace Kai {
 		/// Return the operands (o1 o2 o3) if they are given.
 		Cell * operands();
 		
-		/// Evaluate the operands in the current stack frame.
+		/// Evaluate the operands in the current stack frame, if they haven't been evaluated already, and return the number of arguments. The operands which follow an argument which returns are not evaluated.
+		std::size_t evaluate_arguments();
+		
+		/// Store the given values as the evaluated arguments of this frame, preceded by the receiver if given.
+		void assign_arguments(Object * const * values, std::size_t count, Object * receiver = NULL);
+		
+		/// Return true if the arguments have been evaluated.
+		bool evaluated() const { return _values != NULL; }
+		
+		/// The evaluated arguments, which are stored contiguously.
+		Object ** argument_values() { return _values; }
+		std::size_t argument_count() const { return _count; }
+		
+		/// Return the evaluated argument at the given index, or NULL if there is no such argument.
+		Object * argument(std::size_t index) const {
+			return index < _count ? _values[index] : NULL;
+		}
+		
+		/// Evaluate the arguments as above, and return them as a list.
 		Cell * unwrap();
 		
-		/// Return the arguments if they have been evaluated.
+		/// Return the arguments as a list if they have been evaluated.
 		Cell * arguments();
 		
+		/// Extract the evaluated arguments, or the operands if evaluate is false.
 		ArgumentExtractor extract(bool evaluate = true);
 		
 		bool top();
@@ -181,6 +257,18 @@ namespace Kai {
 		
 		//Symbol * builtin_function();
 	};
+	
+	/** A frame which is allocated on the native stack, used for the evaluation of messages and lambda bodies.
+	 
+	 Heap allocated objects must never refer to a transient frame, so anything which captures a frame needs to use Frame::promote() first.
+	 */
+	class TransientFrame : public Frame {
+	public:
+		TransientFrame(Object * scope, Frame * previous);
+		TransientFrame(Object * scope, Cell * message, Frame * previous);
+		
+		virtual ~TransientFrame();
+	};
 }
 
 #endif
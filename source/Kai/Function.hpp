@@ -11,9 +11,20 @@
 #define _KFUNCTION_H
 
 #include "Object.hpp"
+#include "Frame.hpp"
+#include "Logic.hpp"
+#include "Exception.hpp"
+
+#include <initializer_list>
+#include <string>
+#include <tuple>
+#include <utility>
 
 #define KAI_BUILTIN_FUNCTION(function) (builtin_function<&function>(#function))
 
+/// Bind a function which takes typed arguments, e.g. KAI_TYPED_FUNCTION(Integer::modulus, "self", "base"). The names of the arguments are optional, and are used for error messages.
+#define KAI_TYPED_FUNCTION(function, ...) (typed_function<decltype(&function), &function>(#function, {__VA_ARGS__}))
+
 namespace Kai {
 	
 	typedef Object * (*EvaluateFunctionT)(Frame *);
@@ -48,6 +59,147 @@ namespace Kai {
 		return &instance;
 	}
 	
+// MARK: -
+	
+	/// Converts an evaluated argument to the type of a parameter of a typed function.
+	template <typename ParameterT>
+	struct TypedArgument;
+	
+	/// Arguments which are objects must be non-NULL and of the given type.
+	template <typename ObjectT>
+	struct TypedArgument<ObjectT *> {
+		static const char * type() {
+			return ObjectT::NAME;
+		}
+		
+		static ObjectT * convert(Object * value, bool & valid) {
+			ObjectT * result = ptr(value).as<ObjectT>();
+			
+			valid = result != NULL;
+			
+			return result;
+		}
+	};
+	
+	/// The signature of a typed function, which takes the frame followed by its arguments.
+	template <typename SignatureT>
+	struct TypedSignature;
+	
+	template <typename ResultT, typename... ParametersT>
+	struct TypedSignature<ResultT (*)(Frame *, ParametersT...)> {
+		typedef ResultT (*FunctionT)(Frame *, ParametersT...);
+		
+		enum { ARITY = sizeof...(ParametersT) };
+		
+		static const char * type(std::size_t index) {
+			// The trailing NULL avoids an empty array if there are no parameters:
+			static const char * const types[] = {TypedArgument<ParametersT>::type()..., NULL};
+			
+			return types[index];
+		}
+		
+		template <typename ParameterT>
+		static ParameterT convert(Object * value, std::size_t index, std::size_t & invalid) {
+			bool valid = true;
+			ParameterT result = TypedArgument<ParameterT>::convert(value, valid);
+			
+			if (!valid && invalid == ARITY)
+				invalid = index;
+			
+			return result;
+		}
+		
+		/// Returns ARITY if all the arguments were converted, otherwise the index of the first argument which wasn't.
+		template <FunctionT FUNCTION, std::size_t... INDICES>
+		static std::size_t call(Frame * frame, Object ** values, Ref<Object> & result, std::index_sequence<INDICES...>) {
+			std::size_t invalid = ARITY;
+			
+			// Elements of a braced initialiser are evaluated in order, so the first invalid argument is the one reported:
+			std::tuple<ParametersT...> arguments{convert<ParametersT>(values[INDICES], INDICES, invalid)...};
+			
+			if (invalid == ARITY)
+				result = FUNCTION(frame, std::get<INDICES>(arguments)...);
+			
+			return invalid;
+		}
+	};
+	
+	/** A builtin function whose arguments are unpacked and checked according to its C++ signature, e.g. Ref<Object> modulus(Frame * frame, Integer * self, Integer * base). The arity and types are known at compile time, so the evaluated arguments are converted directly without constructing a list.
+	 
+	 Like ArgumentExtractor, any additional arguments are ignored.
+	 */
+	template <typename SignatureT, SignatureT FUNCTION>
+	class TypedFunction : public Object {
+	protected:
+		typedef TypedSignature<SignatureT> TypedSignatureT;
+		
+		enum { ARITY = TypedSignatureT::ARITY };
+		
+		const char * _name;
+		const char * _names[ARITY + 1];
+		
+		StringT argument_name(std::size_t index) const {
+			if (_names[index])
+				return _names[index];
+			else
+				return "argument " + std::to_string(index + 1);
+		}
+		
+	public:
+		static const char * const NAME;
+		
+		TypedFunction(const char * name, std::initializer_list<const char *> names) : _name(name) {
+			std::size_t index = 0;
+			
+			for (const char * argument_name : names) {
+				if (index < ARITY)
+					_names[index++] = argument_name;
+			}
+			
+			while (index <= ARITY)
+				_names[index++] = NULL;
+		}
+		
+		virtual Ref<Object> evaluate(Frame * frame) {
+			std::size_t count = frame->evaluate_arguments();
+			
+			// An argument may have returned, in which case the function is not called:
+			if (Return::pending())
+				return NULL;
+			
+			if (count < ARITY) {
+				throw ArgumentError(argument_name(count), TypedSignatureT::type(count), NULL, frame);
+			}
+			
+			Object ** values = frame->argument_values();
+			Ref<Object> result;
+			
+			std::size_t invalid = TypedSignatureT::template call<FUNCTION>(frame, values, result, std::make_index_sequence<ARITY>());
+			
+			if (invalid != ARITY) {
+				throw ArgumentError(argument_name(invalid), TypedSignatureT::type(invalid), values[invalid], frame);
+			}
+			
+			return result;
+		}
+		
+		virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
+			buffer << "(builtin-function " << _name << ")";
+		}
+	};
+	
+	template <typename SignatureT, SignatureT FUNCTION>
+	const char * const TypedFunction<SignatureT, FUNCTION>::NAME = "BuiltinFunction";
+	
+	template <typename SignatureT, SignatureT FUNCTION>
+	TypedFunction<SignatureT, FUNCTION> * typed_function(const char * name, std::initializer_list<const char *> names) {
+		static TypedFunction<SignatureT, FUNCTION> instance(name, names);
+		
+		return &instance;
+	}
+	
+// MARK: -
+	
 	class DynamicFunction : public Object {
 	protected:
 		EvaluateFunctionT _evaluate_function;
@@ -13,6 +13,9 @@
 #include "Function.hpp"
 #include "Array.hpp"
 #include "Logic.hpp"
+#include "Bytecode/Code.hpp"
+
+#include <new>
 
 namespace Kai {
 	
@@ -20,7 +23,118 @@ namespace Kai {
 	
 	const char * const Lambda::NAME = "Lambda";
 	
-	Lambda::Lambda(Frame * scope, Cell * arguments, Cell * code) : _scope(scope), _arguments(arguments), _code(code), _macro(false) {
+	typedef std::vector<Cell *> EnvironmentT;
+	
+	static bool is_lambda_form(Object * code) {
+		Cell * cell = ptr(code).as<Cell>();
+		
+		if (cell) {
+			Symbol * head = cell->head().as<Symbol>();
+			
+			if (head) {
+				return head->value() == "lambda" || head->value() == "macro";
+			}
+		}
+		
+		return false;
+	}
+	
+	/// Replace references to the arguments in the given environment with lexical symbols. Nested lambdas are resolved when they are created, so they are left untouched. Cells are only copied if something inside them changed, as the original code may be shared.
+	static Object * resolve(Frame * frame, Object * code, const EnvironmentT & environment) {
+		Symbol * symbol = ptr(code).as<Symbol>();
+		
+		if (symbol) {
+			const StringT & name = symbol->value();
+			
+			// These are provided implicitly by every lambda scope, so they can't refer to an enclosing scope.
+			if (name[0] == ':' || name == "frame" || name == "caller" || name == "callee")
+				return code;
+			
+			for (unsigned depth = 0; depth < environment.size(); depth += 1) {
+				unsigned slot = 0;
+				
+				for (Cell * names = environment[depth]; names != NULL; names = names->tail().as<Cell>(), slot += 1) {
+					Symbol * argument = names->head().as<Symbol>();
+					
+					if (argument && symbol->compare(argument) == EQUAL) {
+						return new(frame) LexicalSymbol(name, environment[depth], depth, slot);
+					}
+				}
+			}
+			
+			return code;
+		}
+		
+		Cell * cell = ptr(code).as<Cell>();
+		
+		if (cell && !is_lambda_form(cell)) {
+			Object * head = resolve(frame, cell->head(), environment);
+			Object * tail = resolve(frame, cell->tail(), environment);
+			
+			if (head != cell->head() || tail != cell->tail()) {
+				return new(frame) Cell(head, tail);
+			}
+		}
+		
+		return code;
+	}
+	
+	/// Returns true if the code refers to the scope of its caller, either explicitly or using dynamic scope.
+	static bool refers_to_caller(Object * code) {
+		Symbol * symbol = ptr(code).as<Symbol>();
+		
+		if (symbol) {
+			const StringT & name = symbol->value();
+			
+			return name == "caller" || name == "frame" || name == "dynamic-scope";
+		}
+		
+		Cell * cell = ptr(code).as<Cell>();
+		
+		if (cell) {
+			return refers_to_caller(cell->head()) || refers_to_caller(cell->tail());
+		}
+		
+		return false;
+	}
+	
+	Lambda::Lambda(Frame * scope, Cell * arguments, Cell * code) : Object(LAMBDA_TAG), _scope(scope), _arguments(arguments), _code(code), _dynamic_scope_chain(NULL), _body(code), _arity(0), _compiled(NULL), _native(NULL), _tier(Tiering::INTERPRETED), _promotable(true), _calls(0), _iterations(0), _reflective(false), _macro(false) {
+		if (_arguments)
+			_arity = _arguments->count();
+		
+		// Arguments are bound in slots rather than tables, so their names can't be cached:
+		for (Cell * names = _arguments; names != NULL; names = names->tail().as<Cell>()) {
+			Symbol * name = names->head().as<Symbol>();
+			
+			if (name)
+				Bindings::define_implicitly(name);
+		}
+		
+		_reflective = refers_to_caller(_code);
+		
+		_dynamic_scope_chain = scope->lookup(scope->sym("dynamic-scope-chain")).as<Array>();
+		
+		if (_code) {
+			EnvironmentT environment;
+			
+			environment.push_back(_arguments);
+			
+			// Find the arguments of all enclosing lambdas, up to the first non-lambda scope:
+			for (Frame * frame = scope; frame != NULL; frame = frame->previous()) {
+				Object * local_scope = frame->local_scope();
+				
+				if (local_scope) {
+					Locals * locals = ptr(local_scope).as<Locals>();
+					
+					if (locals == NULL)
+						break;
+					
+					environment.push_back(locals->lambda()->arguments());
+				}
+			}
+			
+			_body = resolve(scope, _code, environment);
+		}
 	}
 	
 	Lambda::~Lambda () {
@@ -34,58 +148,107 @@ namespace Kai {
 		traversal->traverse(_scope);
 		traversal->traverse(_arguments);
 		traversal->traverse(_code);
+		traversal->traverse(_dynamic_scope_chain);
+		traversal->traverse(_body);
+		traversal->traverse(_compiled);
+		traversal->traverse(_native);
+	}
+	
+	void Lambda::set_compiled(Bytecode::Code * compiled) {
+		_compiled = compiled;
+		
+		if (_tier < Tiering::COMPILED)
+			_tier = Tiering::COMPILED;
+	}
+	
+	void Lambda::set_native(NativeCode * native) {
+		_native = native;
+		_tier = Tiering::NATIVE;
 	}
 	
 	struct LambdaScope {
 		Array * _chain;
 		
-		LambdaScope(Frame * frame, Frame * scope) {
-			_chain = frame->lookup(frame->sym("dynamic-scope-chain")).as<Array>();
-			
-			_chain->value().push_back(scope);
+		LambdaScope(Array * chain, Frame * scope) : _chain(chain) {
+			if (_chain)
+				_chain->value().push_back(scope);
 		}
 		
 		~LambdaScope() {
-			_chain->value().pop_back();
+			if (_chain)
+				_chain->value().pop_back();
 		}
 	};
 	
 	Ref<Object> Lambda::evaluate(Frame * frame) {
-		Table * locals = new(frame) Table;
+		Trampoline * trampoline = frame->trampoline();
+		Cell * body = ptr(_body).as<Cell>();
 		
-		Cell * names = _arguments;
-		Cell * values = NULL;
+		// The body of the lambda is in tail position, so if the lambda is being applied by a trampoline, the activation replaces the current one. Macros and reflective lambdas need the scope of their caller, so it can't be replaced:
+		bool tail = trampoline && body && !_macro && !_reflective && trampoline->current() == frame && frame->function().get() == this;
 		
-		if (is_macro()) {
-			values = frame->operands();
-		} else {
-			values = frame->unwrap();
+		profile(frame, tail);
+		
+		// Native code doesn't have an activation, so it is called directly:
+		if (tail && !_native) {
+			trampoline->enter(this, body, frame);
+			
+			return NULL;
 		}
 		
-		while (names != NULL) {
-			if (values == NULL) {
-				throw Exception("Lambda Arity Mismatch", frame);
-			}
+		// The locals and the frame for the body are allocated on the stack, and are only promoted to the heap if they are captured.
+		Locals locals(this, frame, true);
+		locals.bind(frame);
+		
+		// An argument may have returned, in which case the body is not evaluated:
+		if (Return::pending())
+			return NULL;
+		
+		if (_native) {
+			Tiering::Scope tier(Tiering::NATIVE);
+			Ref<Object> result;
 			
-			locals->update(names->head().as<Symbol>(), values->head());
+			if (_native->call(frame, locals.slots(), _arity, result))
+				return result;
+		}
+		
+		return invoke(&locals);
+	}
+	
+	Ref<Object> Lambda::call(Frame * frame, Object ** arguments, std::size_t count) {
+		profile(frame, false);
+		
+		if (_native && !_macro) {
+			Tiering::Scope tier(Tiering::NATIVE);
+			Ref<Object> result;
 			
-			names = names->tail().as<Cell>();
-			values = values->tail().as<Cell>();
+			if (_native->call(frame, arguments, count, result))
+				return result;
 		}
 		
-		// Give the execution scope access to the executing lambda:
-		locals->update(frame->sym("frame"), frame);
-		locals->update(frame->sym("caller"), frame->scope());
-		locals->update(frame->sym("callee"), this);
+		Locals locals(this, frame, true);
 		
-		{			
-			Frame * next = new(frame) Frame(locals, _scope);
-			LambdaScope lambda_scope(frame, next);
+		if (_macro || !locals.bind(arguments, count)) {
+			throw Exception("Lambda Arity Mismatch", frame);
+		}
+		
+		return invoke(&locals);
+	}
+	
+	Ref<Object> Lambda::invoke(Locals * locals) {
+		TransientFrame next(locals, _scope);
+		LambdaScope lambda_scope(_dynamic_scope_chain, &next);
+		
+		if (_compiled) {
+			Tiering::Scope tier(Tiering::COMPILED);
 			
-			if (_code)
-				return _code->evaluate(next);
-			else
-				return NULL;
+			return _compiled->evaluate(&next);
+		} else if (_body) {
+			Tiering::Scope tier(Tiering::INTERPRETED);
+			
+			return _body->evaluate(&next);
+		} else {
+			return NULL;
 		}
 	}
 	
@@ -167,7 +330,7 @@ namespace Kai {
 		
 		frame->extract()[arguments][code];
 		
-		return new(frame) Lambda(frame, arguments, code);
+		return new(frame) Lambda(frame->promote(), arguments, code);
 	}
 	
 	Ref<Object> Lambda::macro(Frame * frame) {
@@ -175,7 +338,7 @@ namespace Kai {
 		
 		frame->extract()[arguments][code];
 		
-		Lambda * lambda = new(frame) Lambda(frame, arguments, code);
+		Lambda * lambda = new(frame) Lambda(frame->promote(), arguments, code);
 		lambda->set_macro(true);
 		
 		return lambda;
@@ -199,6 +362,11 @@ namespace Kai {
 	}
 	
 	void Lambda::import(Frame * frame) {
+		// These names are provided by the scope of every lambda:
+		Bindings::define_implicitly(frame->sym("frame"));
+		Bindings::define_implicitly(frame->sym("caller"));
+		Bindings::define_implicitly(frame->sym("callee"));
+		
 		Table * prototype = new(frame) Table;
 		
 		prototype->update(frame->sym("is-macro?"), KAI_BUILTIN_FUNCTION(Lambda::is_macro));
@@ -215,4 +383,387 @@ namespace Kai {
 		frame->update(frame->sym("dynamic-scope"), KAI_BUILTIN_FUNCTION(Lambda::dynamic_scope));
 	}
 	
+// MARK: -
+	
+	const char * const Locals::NAME = "Locals";
+	
+	Locals::Locals(Lambda * lambda, Frame * frame, bool transient) : Object(LOCALS_TAG), _lambda(lambda), _frame(frame), _slots(_inline_slots), _count(0), _table(NULL), _materialised(false), _transient(transient), _promoted(NULL) {
+		if (_transient) {
+			// This object wasn't allocated by a memory allocator, so it has no allocation meta-data:
+			_next = NULL;
+			_flags = 0;
+		}
+	}
+	
+	Locals::~Locals() {
+		if (_slots != _inline_slots)
+			delete[] _slots;
+	}
+	
+	Ref<Symbol> Locals::identity(Frame * frame) const {
+		return frame->sym(NAME);
+	}
+	
+	void Locals::mark(Memory::Traversal * traversal) const {
+		traversal->traverse(_lambda);
+		traversal->traverse(_frame);
+		traversal->traverse(_table);
+		
+		for (std::size_t i = 0; i < _count; i += 1) {
+			traversal->traverse(_slots[i]);
+		}
+	}
+	
+	void Locals::allocate_slots(std::size_t count) {
+		if (count > INLINE_SLOTS)
+			_slots = new Object * [count];
+		
+		_count = count;
+	}
+	
+	int Locals::index_of(Symbol * identifier) const {
+		int index = 0;
+		
+		for (Cell * names = _lambda->arguments(); names != NULL; names = names->tail().as<Cell>(), index += 1) {
+			if (identifier->compare(names->head().as<Symbol>()) == EQUAL)
+				return index;
+		}
+		
+		return -1;
+	}
+	
+	bool Locals::bind(Cell * values) {
+		allocate_slots(_lambda->arity());
+		
+		for (std::size_t i = 0; i < _count; i += 1) {
+			if (values == NULL)
+				return false;
+			
+			_slots[i] = values->head();
+			
+			values = values->tail().as<Cell>();
+		}
+		
+		return true;
+	}
+	
+	bool Locals::bind(Object ** values, std::size_t count) {
+		allocate_slots(_lambda->arity());
+		
+		if (count < _count)
+			return false;
+		
+		std::copy(values, values + _count, _slots);
+		
+		return true;
+	}
+	
+	bool Locals::bind_operands(Frame * frame) {
+		allocate_slots(_lambda->arity());
+		
+		std::size_t index = 0;
+		
+		// All operands are evaluated, even if there are more than required:
+		for (Cell * operands = frame->operands(); operands != NULL; operands = operands->tail().as<Cell>(), index += 1) {
+			Ref<Object> value = NULL;
+			
+			if (operands->head())
+				value = operands->head()->evaluate(frame);
+			
+			if (index < _count)
+				_slots[index] = value;
+		}
+		
+		return index >= _count;
+	}
+	
+	void Locals::bind(Frame * frame) {
+		bool bound = false;
+		
+		if (_lambda->is_macro()) {
+			bound = bind(frame->operands());
+		} else if (frame->evaluated()) {
+			bound = bind(frame->argument_values(), frame->argument_count());
+		} else {
+			bound = bind_operands(frame);
+		}
+		
+		if (!bound) {
+			throw Exception("Lambda Arity Mismatch", frame);
+		}
+	}
+	
+	Object * Locals::slot(std::size_t index) {
+		if (_promoted)
+			return _promoted->slot(index);
+		
+		if (_materialised) {
+			Cell * names = _lambda->arguments();
+			
+			while (index--) {
+				names = names->tail().as<Cell>();
+			}
+			
+			return _table->lookup(_frame, names->head().as<Symbol>());
+		}
+		
+		return _slots[index];
+	}
+	
+	bool Locals::defines(Symbol * identifier) {
+		if (_promoted)
+			return _promoted->defines(identifier);
+		
+		if (!_materialised && index_of(identifier) != -1)
+			return true;
+		
+		return _table && _table->find(identifier);
+	}
+	
+	Ref<Object> Locals::lookup(Frame * frame, Symbol * identifier) {
+		if (_promoted)
+			return _promoted->lookup(frame, identifier);
+		
+		if (!_materialised) {
+			int index = index_of(identifier);
+			
+			if (index != -1)
+				return _slots[index];
+			
+			// Give the execution scope access to the executing lambda:
+			const StringT & name = identifier->value();
+			
+			if (name == "frame") {
+				return _frame->promote();
+			} else if (name == "caller") {
+				return _frame->scope();
+			} else if (name == "callee") {
+				return _lambda;
+			}
+		}
+		
+		if (_table)
+			return _table->lookup(frame, identifier);
+		
+		return NULL;
+	}
+	
+	void Locals::update(Symbol * identifier, Object * value) {
+		if (_promoted) {
+			_promoted->update(identifier, value);
+			
+			return;
+		}
+		
+		if (!_materialised) {
+			int index = index_of(identifier);
+			
+			if (index != -1) {
+				_slots[index] = value;
+				
+				return;
+			}
+		}
+		
+		if (!_table)
+			_table = new(_frame) Table;
+		
+		_table->update(identifier, value);
+	}
+	
+	Table * Locals::table() {
+		if (_promoted)
+			return _promoted->table();
+		
+		if (!_materialised) {
+			if (!_table)
+				_table = new(_frame) Table;
+			
+			std::size_t index = 0;
+			
+			for (Cell * names = _lambda->arguments(); names != NULL; names = names->tail().as<Cell>(), index += 1) {
+				_table->update(names->head().as<Symbol>(), _slots[index]);
+			}
+			
+			_table->update(_frame->sym("frame"), _frame->promote());
+			_table->update(_frame->sym("caller"), _frame->scope());
+			_table->update(_frame->sym("callee"), _lambda);
+			
+			_materialised = true;
+		}
+		
+		return _table;
+	}
+	
+	Locals * Locals::promote() {
+		if (!_transient) return this;
+		
+		if (!_promoted) {
+			Frame * frame = _frame->promote();
+			
+			Locals * locals = new(frame) Locals(_lambda, frame);
+			
+			locals->allocate_slots(_count);
+			std::copy(_slots, _slots + _count, locals->_slots);
+			
+			locals->_table = _table;
+			locals->_materialised = _materialised;
+			
+			_promoted = locals;
+		}
+		
+		return _promoted;
+	}
+	
+	void Locals::to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const {
+		buffer << "(locals@" << this << ")";
+	}
+	
+// MARK: -
+	
+	void Trampoline::Activation::release() {
+		if (active) {
+			get_frame()->~TransientFrame();
+			get_locals()->~Locals();
+			
+			active = false;
+		}
+	}
+	
+	Trampoline::Trampoline(Frame * caller) : _caller(caller), _current(caller), _next(NULL), _activation(NULL), _next_activation(NULL), _dynamic_scope_chain(NULL), _returns(false), _tier(Tiering::current()) {
+		_activations[0].active = false;
+		_activations[1].active = false;
+		
+		_caller->_trampoline = this;
+	}
+	
+	Trampoline::~Trampoline() {
+		if (_dynamic_scope_chain)
+			_dynamic_scope_chain->value().pop_back();
+		
+		_activations[0].release();
+		_activations[1].release();
+		
+		_caller->_trampoline = NULL;
+		
+		Tiering::enter(_tier);
+	}
+	
+	void Trampoline::tail_call(Frame * frame, bool block) {
+		_next = frame;
+		
+		if (block)
+			_returns = true;
+	}
+	
+	void Trampoline::enter(Lambda * lambda, Cell * body, Frame * frame) {
+		// Use whichever activation is not currently in use, as the arguments may refer to the current activation:
+		Activation * activation = (_activation == &_activations[0]) ? &_activations[1] : &_activations[0];
+		
+		// In a tail call, the callee returns directly to the caller of the frame which is being replaced:
+		Locals * locals = ::new(activation->locals) Locals(lambda, _caller, true);
+		
+		try {
+			locals->bind(frame);
+		} catch (...) {
+			locals->~Locals();
+			
+			throw;
+		}
+		
+		// An argument may have returned, in which case the body is not evaluated:
+		if (Return::pending()) {
+			locals->~Locals();
+			
+			return;
+		}
+		
+		TransientFrame * next = ::new(activation->frame) TransientFrame(locals, body, lambda->scope());
+		next->_trampoline = this;
+		
+		// Compiled code is applied directly, rather than evaluating the body:
+		if (lambda->compiled())
+			next->_function = lambda->compiled();
+		activation->active = true;
+		
+		_next = next;
+		_next_activation = activation;
+	}
+	
+	Frame * Trampoline::next() {
+		_current = _next;
+		_next = NULL;
+		
+		if (_next_activation) {
+			Frame * frame = _next_activation->get_frame();
+			
+			// Replace the lambda scope of the previous activation:
+			if (_dynamic_scope_chain) {
+				_dynamic_scope_chain->value().back() = frame;
+			} else {
+				_dynamic_scope_chain = _next_activation->get_locals()->lambda()->dynamic_scope_chain();
+				
+				if (_dynamic_scope_chain)
+					_dynamic_scope_chain->value().push_back(frame);
+			}
+			
+			if (_activation)
+				_activation->release();
+			
+			_activation = _next_activation;
+			_next_activation = NULL;
+			
+			Lambda * lambda = _activation->get_locals()->lambda();
+			Tiering::enter(lambda->compiled() ? Tiering::COMPILED : Tiering::INTERPRETED);
+		}
+		
+		return _current;
+	}
+	
+// MARK: -
+	
+	LexicalSymbol::LexicalSymbol(const StringT & value, Cell * arguments, unsigned depth, unsigned slot) : Symbol(value), _arguments(arguments), _depth(depth), _slot(slot) {
+		_tag = LEXICAL_SYMBOL_TAG;
+	}
+	
+	LexicalSymbol::~LexicalSymbol() {
+	}
+	
+	void LexicalSymbol::mark(Memory::Traversal * traversal) const {
+		Symbol::mark(traversal);
+		
+		traversal->traverse(_arguments);
+	}
+	
+	Ref<Object> LexicalSymbol::evaluate(Frame * frame) {
+		unsigned depth = _depth;
+		
+		for (Frame * current = frame; current != NULL; current = current->previous()) {
+			Object * local_scope = current->local_scope();
+			
+			if (!local_scope)
+				continue;
+			
+			Locals * locals = ptr(local_scope).as<Locals>();
+			
+			if (locals == NULL)
+				break;
+			
+			if (depth == 0) {
+				if (locals->lambda()->arguments() == _arguments)
+					return locals->slot(_slot);
+				
+				break;
+			}
+			
+			// An intermediate scope which defines the same name shadows the argument:
+			if (locals->defines(this))
+				break;
+			
+			depth -= 1;
+		}
+		
+		return Symbol::evaluate(frame);
+	}
+	
 }
@@ -12,9 +12,20 @@
 
 #include "Object.hpp"
 #include "Cell.hpp"
+#include "Symbol.hpp"
+#include "Frame.hpp"
+#include "Tiering.hpp"
 
 namespace Kai {
 	
+	class Array;
+	class Table;
+	class Locals;
+	
+	namespace Bytecode {
+		class Code;
+	}
+	
 // MARK: -
 // MARK: Lambda
 	
@@ -24,8 +35,34 @@ namespace Kai {
 		Cell * _arguments;
 		Cell * _code;
 		
+		/// The stack of lambda scopes used by dynamic-scope, cached when the lambda is created.
+		Array * _dynamic_scope_chain;
+		
+		/// The code with references to lexical variables resolved, which is evaluated in place of _code.
+		Object * _body;
+		
+		std::size_t _arity;
+		
+		/// If the body has been compiled, the code which is executed in place of _body.
+		Bytecode::Code * _compiled;
+		
+		/// If the lambda has been compiled to native code, it is tried before _compiled.
+		NativeCode * _native;
+		
+		Tiering::Tier _tier;
+		bool _promotable;
+		
+		Tiering::CountT _calls;
+		Tiering::CountT _iterations;
+		
+		/// True if the code refers to the scope of its caller, in which case it can't replace its caller in a tail call.
+		bool _reflective;
+		
 		bool _macro;
 		
+		/// Evaluate the body of the lambda with the given locals, which have already been bound.
+		Ref<Object> invoke(Locals * locals);
+		
 	public:
 		static const char * const NAME;
 		
@@ -37,10 +74,44 @@ namespace Kai {
 		bool is_macro() const { return _macro; }
 		void set_macro(bool macro) { _macro = macro; }
 		
+		bool is_reflective() const { return _reflective; }
+		
+		Frame * scope() const { return _scope; }
+		Cell * arguments() const { return _arguments; }
+		std::size_t arity() const { return _arity; }
+		Object * body() const { return _body; }
+		Array * dynamic_scope_chain() const { return _dynamic_scope_chain; }
+		
+		Bytecode::Code * compiled() const { return _compiled; }
+		void set_compiled(Bytecode::Code * compiled);
+		
+		NativeCode * native() const { return _native; }
+		void set_native(NativeCode * native);
+		
+		Tiering::Tier tier() const { return _tier; }
+		void set_promotable(bool promotable) { _promotable = promotable; }
+		
+		Tiering::CountT calls() const { return _calls; }
+		Tiering::CountT iterations() const { return _iterations; }
+		
+		/// Count a call, or an iteration if the lambda is replacing an activation, and promote the lambda if it has become hot.
+		void profile(Frame * frame, bool iteration) {
+			if (iteration)
+				_iterations += 1;
+			else
+				_calls += 1;
+			
+			if (_calls + _iterations >= Tiering::threshold(_tier) && _promotable)
+				Tiering::promote(frame, this);
+		}
+		
 		virtual void mark(Memory::Traversal * traversal) const;
 		
 		virtual Ref<Object> evaluate(Frame * frame);
 		
+		/// Apply the lambda to arguments which have already been evaluated, e.g. by compiled code.
+		Ref<Object> call(Frame * frame, Object ** arguments, std::size_t count);
+		
 		virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const;
 		
 		static Ref<Object> to_macro(Frame * frame);
@@ -56,6 +127,180 @@ namespace Kai {
 		static void import(Frame *);
 	};
 	
+// MARK: -
+// MARK: Locals
+	
+	/** The local variables of an executing lambda.
+	 
+	 Arguments are stored in a fixed slot vector in the same order as the lambda's argument list, so that a LexicalSymbol can read them without hashing. Any other variables defined in the scope are stored in a table which is only allocated when required.
+	 
+	 If the scope itself is reflected on (e.g. using `self` or `caller`), the locals are materialised into a real Table, and from then on all access is forwarded to it.
+	 
+	 Locals are normally allocated on the native stack along with the TransientFrame which evaluates the lambda body. If they are captured, they are promoted to the heap, and the transient locals forward all access to the promoted copy.
+	 */
+	class Locals : public Object {
+	protected:
+		/// Most lambdas have only a few arguments, which can be stored without any additional allocation.
+		enum { INLINE_SLOTS = 8 };
+		
+		Lambda * _lambda;
+		
+		/// The frame which invoked the lambda.
+		Frame * _frame;
+		
+		Object ** _slots;
+		std::size_t _count;
+		Object * _inline_slots[INLINE_SLOTS];
+		
+		/// Variables other than the arguments, or all variables once materialised.
+		Table * _table;
+		bool _materialised;
+		
+		bool _transient;
+		Locals * _promoted;
+		
+		/// Returns the index of the given argument, or -1 if it is not an argument.
+		int index_of(Symbol * identifier) const;
+		
+		void allocate_slots(std::size_t count);
+		
+	public:
+		static const char * const NAME;
+		
+		Locals(Lambda * lambda, Frame * frame, bool transient = false);
+		virtual ~Locals();
+		
+		virtual Ref<Symbol> identity(Frame * frame) const;
+		
+		virtual void mark(Memory::Traversal * traversal) const;
+		
+		Lambda * lambda() const { return _lambda; }
+		
+		/// The frame which invoked the lambda.
+		Frame * frame() const { return _frame; }
+		
+		/// Bind the given values to the arguments of the lambda. Returns false if there were not enough values.
+		bool bind(Cell * values);
+		bool bind(Object ** values, std::size_t count);
+		
+		/// Evaluate the operands of the given frame directly into the argument slots, without constructing an argument list. Returns false if there were not enough operands.
+		bool bind_operands(Frame * frame);
+		
+		/// Bind the arguments of the given frame, as appropriate for the lambda, or throw an exception if there were not enough.
+		void bind(Frame * frame);
+		
+		/// Returns the value of the argument at the given index.
+		Object * slot(std::size_t index);
+		
+		/// The values of the arguments, as bound, before the locals are materialised.
+		Object ** slots() { return _slots; }
+		
+		/// Returns true if the given identifier is defined directly by this scope.
+		bool defines(Symbol * identifier);
+		
+		virtual Ref<Object> lookup(Frame * frame, Symbol * identifier);
+		void update(Symbol * identifier, Object * value);
+		
+		/// Returns a table containing all local variables, materialising it if required.
+		Table * table();
+		
+		/// Returns a heap allocated copy of transient locals, see Frame::promote().
+		Locals * promote();
+		
+		virtual void to_code(Frame * frame, StringStreamT & buffer, MarkedT & marks, std::size_t indentation) const;
+	};
+	
+// MARK: -
+// MARK: Trampoline
+	
+	/** Frame::apply evaluates messages in a loop, so that expressions in tail position (e.g. the last statement of a block, or the body of a lambda) replace the current evaluation rather than nesting within it.
+	 
+	 The trampoline also provides storage for lambda activations. A lambda called in tail position reuses the storage of the activation it replaces, so iterative algorithms written recursively run in constant stack and frame memory.
+	 */
+	class Trampoline {
+	public:
+		/// Storage for the locals and frame of a lambda which was called in tail position.
+		struct Activation {
+			alignas(Locals) Memory::ByteT locals[sizeof(Locals)];
+			alignas(TransientFrame) Memory::ByteT frame[sizeof(TransientFrame)];
+			
+			bool active;
+			
+			Locals * get_locals() { return (Locals *)locals; }
+			TransientFrame * get_frame() { return (TransientFrame *)frame; }
+			
+			void release();
+		};
+		
+	protected:
+		/// The frame which invoked Frame::apply.
+		Frame * _caller;
+		
+		/// The frame which is currently being evaluated.
+		Frame * _current;
+		
+		/// The frame which will be evaluated next, if a tail call was made.
+		Frame * _next;
+		
+		Activation _activations[2];
+		Activation * _activation;
+		Activation * _next_activation;
+		
+		/// The dynamic scope chain, if a lambda scope has been pushed onto it.
+		Array * _dynamic_scope_chain;
+		
+		bool _returns;
+		
+		/// The tier of the caller, which is restored once the trampoline finishes.
+		Tiering::Tier _tier;
+		
+	public:
+		Trampoline(Frame * caller);
+		~Trampoline();
+		
+		Frame * caller() const { return _caller; }
+		Frame * current() const { return _current; }
+		
+		/// True if a block was replaced by a tail call, and so the trampoline is responsible for return.
+		bool returns() const { return _returns; }
+		
+		/// Evaluate the given frame next, once the current function returns.
+		void tail_call(Frame * frame, bool block);
+		
+		/// Bind the arguments of a lambda which is being applied by the current frame, and schedule evaluation of its body.
+		void enter(Lambda * lambda, Cell * body, Frame * frame);
+		
+		/// Returns the next frame to evaluate, or NULL if no tail call was made.
+		Frame * next();
+	};
+	
+// MARK: -
+// MARK: LexicalSymbol
+	
+	/** A reference to a lambda argument, resolved to (depth, slot) coordinates when the lambda was created.
+	 
+	 The depth is the number of enclosing lambda scopes between the reference and the lambda which defines the argument. If the scopes found at run time don't match (e.g. because a non-lambda scope such as `with` intervenes), evaluation falls back to a normal symbol lookup.
+	  */
+	class LexicalSymbol : public Symbol {
+	protected:
+		/// The argument list of the lambda which defines the variable, used to validate the lookup.
+		Cell * _arguments;
+		
+		unsigned _depth;
+		unsigned _slot;
+		
+	public:
+		LexicalSymbol(const StringT & value, Cell * arguments, unsigned depth, unsigned slot);
+		virtual ~LexicalSymbol();
+		
+		virtual void mark(Memory::Traversal * traversal) const;
+		
+		unsigned depth() const { return _depth; }
+		unsigned slot() const { return _slot; }
+		
+		virtual Ref<Object> evaluate(Frame * frame);
+	};
+	
 }
 
 #endif
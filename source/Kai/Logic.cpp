@@ -21,7 +21,7 @@ namespace Kai {
 		while (cur != NULL) {
 			Ref<Object> value = cur->head()->evaluate(frame);
 			
-			if (Object::to_boolean(frame, value)) {
+			if (Return::pending() || Object::to_boolean(frame, value)) {
 				return value;
 			}
 			
@@ -37,6 +37,9 @@ namespace Kai {
 		while (cur != NULL) {
 			Ref<Object> value = cur->head()->evaluate(frame);
 			
+			if (Return::pending())
+				return value;
+			
 			if (!Object::to_boolean(frame, value)) {
 				return Symbol::false_symbol(frame);					
 			}
@@ -48,12 +51,10 @@ namespace Kai {
 	}
 	
 	Ref<Object> Logic::not_ (Frame * frame) {
-		Cell * cur = frame->unwrap();
-		
-		if (cur == NULL)
+		if (frame->evaluate_arguments() == 0)
 			throw Exception("Invalid Argument", frame);
 		
-		if (Object::to_boolean(frame, cur->head())) {
+		if (Object::to_boolean(frame, frame->argument(0))) {
 			return Symbol::false_symbol(frame);
 		}
 		
@@ -71,12 +72,12 @@ namespace Kai {
 		while (args) {
 			Object * condition, * code;
 			
-			args[condition][code];
+			args = args[condition][code];
 			
 			condition = condition->evaluate(frame);
 			
 			if (Object::compare(value, condition) == EQUAL) {
-				return code->evaluate(frame);
+				return frame->tail(code);
 			}
 		}
 		
@@ -89,12 +90,9 @@ namespace Kai {
 		frame->extract(false)[condition][true_clause][false_clause];
 		
 		if (Object::to_boolean(frame, condition->evaluate(frame))) {
-			return true_clause->evaluate(frame);
+			return frame->tail(true_clause);
 		} else {
-			if (false_clause)
-				return false_clause->evaluate(frame);
-			else
-				return NULL;
+			return frame->tail(false_clause);
 		}
 	}
 	
@@ -109,35 +107,43 @@ namespace Kai {
 	 
 	 */
 	
-	struct ReturnValue {
-		Ref<Object> value;
-	};
+	thread_local bool Return::_pending = false;
+	thread_local Object * Return::_value = NULL;
 	
 	Ref<Object> Logic::return_ (Frame * frame) {
 		Object * result = NULL;
 		
 		frame->extract()[result];
 		
-		ReturnValue r = {result};
+		Return::request(result);
 		
-		throw r;
+		return result;
 	}
 	
 	Ref<Object> Logic::block (Frame * frame) {
-		Ref<Object> result = NULL;
+		Cell * statements = frame->operands();
+		
+		if (statements == NULL)
+			return NULL;
 		
-		try {
-			Cell * statements = frame->operands();
+		Cell * next = statements->tail().as<Cell>();
+		
+		while (next != NULL) {
+			statements->head()->evaluate(frame);
 			
-			while (statements != NULL) {
-				result = statements->head()->evaluate(frame);
-				
-				statements = statements->tail().as<Cell>();
-			}
-		} catch (ReturnValue r) {
-			return r.value;
+			if (Return::pending())
+				return Return::complete();
+			
+			statements = next;
+			next = statements->tail().as<Cell>();
 		}
 		
+		// The last statement is in tail position:
+		Ref<Object> result = frame->tail(statements->head(), true);
+		
+		if (Return::pending())
+			return Return::complete();
+		
 		return result;
 	}
 	
@@ -13,6 +13,34 @@
 
 namespace Kai {
 	
+	/** A pending return unwinds evaluation to the enclosing block, without using exceptions.
+	 
+	 Functions which evaluate a sequence of expressions (e.g. block, and Frame::apply) check for a pending return after each one, and stop evaluating if one is found. The block which completes the return receives its value.
+	 */
+	class Return {
+	protected:
+		static thread_local bool _pending;
+		static thread_local Object * _value;
+		
+	public:
+		static bool pending() { return _pending; }
+		
+		static void request(Object * value) {
+			_pending = true;
+			_value = value;
+		}
+		
+		/// Clear the pending return, and return its value.
+		static Ref<Object> complete() {
+			Object * value = _value;
+			
+			_pending = false;
+			_value = NULL;
+			
+			return value;
+		}
+	};
+	
 	// Because some of these names are C++ keywords, they have an underscore appended.
 	class Logic {			
 	public:
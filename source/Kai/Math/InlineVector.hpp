@@ -0,0 +1,200 @@
+//
+//  InlineVector.h
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#ifndef _KAI_MATH_INLINE_VECTOR_H
+#define _KAI_MATH_INLINE_VECTOR_H
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <stdint.h>
+
+namespace Kai {
+	namespace Math {
+		
+		/** A vector which stores up to INLINE elements inside itself, and only allocates memory when it grows larger than that. Elements are copied as bytes, so they must be trivially copyable.
+		 
+		 Most integers are small, so storing their digits inline means that typical arithmetic doesn't allocate at all.
+		 */
+		template <typename ElementT, std::size_t INLINE>
+		class InlineVector {
+			static_assert(std::is_trivially_copyable<ElementT>::value, "Elements must be trivially copyable!");
+			
+		public:
+			typedef ElementT value_type;
+			typedef ElementT * iterator;
+			typedef const ElementT * const_iterator;
+			
+			// Integers with more than 2^32 digits aren't supported, which keeps the vector small:
+			typedef uint32_t SizeT;
+			
+		protected:
+			ElementT * _elements;
+			SizeT _size, _capacity;
+			
+			ElementT _inline[INLINE];
+			
+			bool is_inline() const { return _elements == _inline; }
+			
+			void release() {
+				if (!is_inline())
+					delete[] _elements;
+			}
+			
+			void grow(std::size_t capacity) {
+				// Grow geometrically, so that repeatedly pushing elements takes amortised constant time:
+				if (capacity < (std::size_t)_capacity * 2)
+					capacity = (std::size_t)_capacity * 2;
+				
+				ElementT * elements = new ElementT[capacity];
+				std::memcpy(elements, _elements, _size * sizeof(ElementT));
+				
+				release();
+				
+				_elements = elements;
+				_capacity = capacity;
+			}
+			
+			void copy(const InlineVector & other) {
+				if (other._size > _capacity)
+					grow(other._size);
+				
+				std::memcpy(_elements, other._elements, other._size * sizeof(ElementT));
+				_size = other._size;
+			}
+			
+			// Take the elements of the other vector. This vector must be empty and must not own any memory.
+			void take(InlineVector & other) {
+				if (other.is_inline()) {
+					std::memcpy(_inline, other._inline, other._size * sizeof(ElementT));
+					_elements = _inline;
+					_capacity = INLINE;
+				} else {
+					_elements = other._elements;
+					_capacity = other._capacity;
+					
+					other._elements = other._inline;
+					other._capacity = INLINE;
+				}
+				
+				_size = other._size;
+				other._size = 0;
+			}
+			
+		public:
+			InlineVector() : _elements(_inline), _size(0), _capacity(INLINE) {
+			}
+			
+			InlineVector(const InlineVector & other) : _elements(_inline), _size(0), _capacity(INLINE) {
+				copy(other);
+			}
+			
+			InlineVector(InlineVector && other) : _elements(_inline), _size(0), _capacity(INLINE) {
+				take(other);
+			}
+			
+			~InlineVector() {
+				release();
+			}
+			
+			InlineVector & operator=(const InlineVector & other) {
+				if (this != &other)
+					copy(other);
+				
+				return *this;
+			}
+			
+			InlineVector & operator=(InlineVector && other) {
+				if (this != &other) {
+					release();
+					
+					_elements = _inline;
+					_capacity = INLINE;
+					
+					take(other);
+				}
+				
+				return *this;
+			}
+			
+			std::size_t size() const { return _size; }
+			std::size_t capacity() const { return _capacity; }
+			bool empty() const { return _size == 0; }
+			
+			ElementT * data() { return _elements; }
+			const ElementT * data() const { return _elements; }
+			
+			iterator begin() { return _elements; }
+			iterator end() { return _elements + _size; }
+			
+			const_iterator begin() const { return _elements; }
+			const_iterator end() const { return _elements + _size; }
+			
+			ElementT & operator[](std::size_t index) { return _elements[index]; }
+			const ElementT & operator[](std::size_t index) const { return _elements[index]; }
+			
+			ElementT & at(std::size_t index) {
+				if (index >= _size)
+					throw std::out_of_range("InlineVector index out of range");
+				
+				return _elements[index];
+			}
+			
+			ElementT & back() { return _elements[_size - 1]; }
+			const ElementT & back() const { return _elements[_size - 1]; }
+			
+			void reserve(std::size_t capacity) {
+				if (capacity > _capacity)
+					grow(capacity);
+			}
+			
+			void push_back(const ElementT & element) {
+				if (_size == _capacity) {
+					// The element might be stored in this vector:
+					ElementT value = element;
+					
+					grow(_size + 1);
+					_elements[_size++] = value;
+				} else {
+					_elements[_size++] = element;
+				}
+			}
+			
+			void pop_back() {
+				_size -= 1;
+			}
+			
+			/// New elements are zeroed, like value initialisation in std::vector.
+			void resize(std::size_t size) {
+				if (size > _capacity)
+					grow(size);
+				
+				if (size > _size)
+					std::memset(_elements + _size, 0, (size - _size) * sizeof(ElementT));
+				
+				_size = size;
+			}
+			
+			void clear() {
+				_size = 0;
+			}
+			
+			void swap(InlineVector & other) {
+				InlineVector temporary(std::move(other));
+				
+				other = std::move(*this);
+				*this = std::move(temporary);
+			}
+		};
+		
+	}
+}
+
+#endif
@@ -12,6 +12,11 @@
 #include <sstream>
 #include <cassert>
 #include <fstream>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 // Memset
 #include <string.h>
@@ -71,28 +76,34 @@ namespace Kai {
 			return ceil(in_length / (log(out_base) / log(in_base)));
 		}
 		
-		IntermediateT Integer::single_precision_base(BaseT base, DigitT & k)
-		{
-			IntermediateT n = base;
-			IntermediateT m;
+		template <typename ValueT>
+		static ValueT largest_power(BaseT base, DigitT & k) {
+			if (base < 2 || base > 36) {
+				throw std::range_error("Could not convert number - base out of range!");
+			}
 			
+			ValueT n = base;
 			k = 1;
 			
-			while (1) {
-				m = n * base;
-				
-				// Overflow
-				if (m < n) {
-					break;
-				}
-				
+			// Stop before the next power would overflow:
+			while (n <= std::numeric_limits<ValueT>::max() / base) {
 				k += 1;
-				n = m;
+				n = n * base;
 			}
 			
 			return n;
 		}
 		
+		IntermediateT Integer::single_precision_base(BaseT base, DigitT & k)
+		{
+			return largest_power<IntermediateT>(base, k);
+		}
+		
+		DigitT Integer::single_digit_base(BaseT base, DigitT & k)
+		{
+			return largest_power<DigitT>(base, k);
+		}
+		
 		std::size_t Integer::single_precision_to_buffer(IntermediateT value, BaseT base, DigitT width, char * buffer)
 		{
 			for (std::size_t i = 0; i < width; ++i) {
@@ -108,71 +119,197 @@ namespace Kai {
 		}
 		
 		Integer::Integer(IntermediateT value) {
-			for (std::size_t i = 0; i < sizeof(value); i += sizeof(DigitT)) {
-				DigitT d = (DigitT)value;
+			// Push digits until the rest of the value fits in the last one:
+			for (std::size_t i = 0; i < INTERMEDIATE_DIGITS; i += 1) {
+				_value.push_back((DigitT)(value >> (i * DIGIT_BITS)));
 				
-				_value.push_back(d);
+				if ((value >> (i * DIGIT_BITS)) == _value.back())
+					break;
+			}
+		}
+		
+// MARK: Radix Conversion
+		
+		// Numbers with fewer digits than this are converted one chunk of characters at a time, and larger ones are split in half recursively.
+		static const std::size_t RADIX_CONVERSION_THRESHOLD = Integer::RADIX_CONVERSION_THRESHOLD;
+		
+		// Multiplies the digits of x by factor and adds addend, returning the carry.
+		static DigitT multiply_add_digit(DigitT * x, std::size_t n, DigitT factor, DigitT addend) {
+			DoubleDigitT carry = addend;
+			
+			for (std::size_t i = 0; i < n; i += 1) {
+				DoubleDigitT result = (DoubleDigitT)x[i] * factor + carry;
 				
-				value = value >> (sizeof(DigitT) * 8);
+				x[i] = (DigitT)result;
+				carry = result >> DIGIT_BITS;
+			}
+			
+			return carry;
+		}
+		
+		// Divides the digits of x by divisor in place, returning the remainder.
+		static DigitT divide_digit(DigitT * x, std::size_t n, DigitT divisor) {
+			DoubleDigitT remainder = 0;
+			
+			for (std::size_t i = n; i > 0; i -= 1) {
+				DoubleDigitT value = (remainder << DIGIT_BITS) | x[i-1];
 				
-				if (value == 0)
-					break;
+				x[i-1] = (DigitT)(value / divisor);
+				remainder = value % divisor;
 			}
+			
+			return remainder;
 		}
 		
-		void Integer::convert_string(std::string value, BaseT base)
-		{
-			IntermediateT intermediate;
-			DigitT k;
-			IntermediateT factor = single_precision_base(base, k);
+		// The powers of a base which are used to split numbers into halves with a whole number of characters in each: powers[i] = base^(k * 2^i), where base^k is the largest power which fits in a single digit. Each power is the square of the previous one, and is calculated when it is first used.
+		class RadixPowers {
+		protected:
+			BaseT _base;
+			DigitT _k, _chunk;
 			
-			// The counter:
-			std::size_t i = 0;
+			std::vector<Integer> _powers;
 			
-			// Do the first i < k numbers, such that there are kn numbers left, e.g. an integer multiple of k.
-			{
-				std::size_t top = value.length() % k;
-				intermediate = 0;
+		public:
+			RadixPowers(BaseT base) : _base(base) {
+				_chunk = Integer::single_digit_base(base, _k);
+				_powers.push_back(Integer(_chunk));
+			}
+			
+			BaseT base() const { return _base; }
+			
+			// The number of characters in each chunk, and base^k.
+			DigitT k() const { return _k; }
+			DigitT chunk() const { return _chunk; }
+			
+			// The number of characters represented by the given power.
+			std::size_t width(std::size_t level) const { return (std::size_t)_k << level; }
+			
+			const Integer & operator[](std::size_t level) {
+				while (_powers.size() <= level) {
+					Integer square;
+					square.set_product(_powers.back(), _powers.back());
+					
+					_powers.push_back(Integer());
+					_powers.back().swap(square);
+				}
+				
+				return _powers[level];
+			}
+		};
+		
+		// Parses the characters from begin to end. Short strings are parsed in chunks of k characters, which are accumulated by multiplying by a single digit. Long strings are split so that the low part has width(level) characters, and the high part is scaled by powers[level].
+		static void parse_digits(const char * begin, const char * end, RadixPowers & powers, Integer & value) {
+			std::size_t length = end - begin;
+			
+			if (length <= powers.width(0) * RADIX_CONVERSION_THRESHOLD) {
+				Integer::ValueT & digits = value.value();
 				
-				for (; i < top; i += 1) {
-					DigitT digit = convert_to_digit(value[i]);
+				digits.clear();
+				digits.push_back(0);
+				
+				while (begin != end) {
+					DigitT accumulator = 0, scale = 1;
+					
+					for (DigitT i = 0; i < powers.k() && begin != end; i += 1, begin += 1) {
+						accumulator = accumulator * powers.base() + convert_to_digit(*begin);
+						scale *= powers.base();
+					}
+					
+					DigitT carry = multiply_add_digit(digits.data(), digits.size(), scale, accumulator);
 					
-					intermediate *= base;
-					intermediate += digit;
+					if (carry)
+						digits.push_back(carry);
 				}
+			} else {
+				std::size_t level = 0;
+				
+				while (powers.width(level + 1) < length)
+					level += 1;
+				
+				const char * middle = end - powers.width(level);
+				
+				Integer high, low;
+				parse_digits(begin, middle, powers, high);
+				parse_digits(middle, end, powers, low);
 				
-				(*this) += intermediate;
+				value.set_product(high, powers[level]);
+				value.add(low);
 			}
+		}
+		
+		// Appends the characters of value, which is less than powers[level], to the buffer. If width is non-zero, the characters are padded with leading zeros to that width. Small numbers are printed by repeatedly dividing by a single digit, and large ones are split into halves by dividing by powers[level-1].
+		static void print_digits(Integer & value, RadixPowers & powers, std::size_t level, std::size_t width, std::string & buffer) {
+			Integer::ValueT & digits = value.value();
 			
-			// We are assuming single bytes per integral value
-			for (; i < value.length(); i += k) {
-				intermediate = 0;
+			if (level == 0 || digits.size() < RADIX_CONVERSION_THRESHOLD) {
+				std::size_t offset = buffer.size(), n = digits.size();
 				
-				for (std::size_t j = i; j < (i+k); j += 1) {
-					DigitT digit = convert_to_digit(value[j]);
+				// The characters are generated in reverse order:
+				while (n > 0) {
+					DigitT remainder = divide_digit(digits.data(), n, powers.chunk());
 					
-					intermediate *= base;
-					intermediate += digit;
+					while (n > 0 && digits[n-1] == 0)
+						n -= 1;
+					
+					for (DigitT i = 0; i < powers.k(); i += 1) {
+						buffer.push_back(convert_to_character(remainder % powers.base()));
+						remainder /= powers.base();
+					}
 				}
 				
-				(*this) *= factor;
-				(*this) += intermediate;
+				// Remove the leading zeros from the last chunk, and then pad to the given width:
+				while (buffer.size() > offset && buffer.back() == '0')
+					buffer.pop_back();
+				
+				if (buffer.size() - offset < width)
+					buffer.append(width - (buffer.size() - offset), '0');
+				
+				std::reverse(buffer.begin() + offset, buffer.end());
+			} else {
+				Integer high, low;
+				high.set_fraction(value, powers[level-1], low);
+				
+				std::size_t half = powers.width(level-1);
+				
+				if (width == 0 && high.is_zero()) {
+					print_digits(low, powers, level-1, 0, buffer);
+				} else {
+					print_digits(high, powers, level-1, width ? width - half : 0, buffer);
+					print_digits(low, powers, level-1, half, buffer);
+				}
 			}
 		}
 		
+		void Integer::convert_string(std::string value, BaseT base)
+		{
+			RadixPowers powers(base);
+			
+			parse_digits(value.data(), value.data() + value.size(), powers, *this);
+		}
+		
+// MARK: -
+		
 		void Integer::convert_base_16_string(std::string value) {
-			_value.resize((value.size() * 4 + (DIGIT_BITS - 1)) / DIGIT_BITS);
+			const std::size_t width = DIGIT_BITS / 4;
 			
+			_value.resize((value.size() + (width - 1)) / width);
+			
+			// Each digit is made from the characters at the same offset from the end of the string, so the most significant digit may be made from fewer characters:
 			for (std::size_t i = 0; i < _value.size(); i += 1) {
+				std::size_t end = value.size() - i * width;
+				std::size_t begin = end > width ? end - width : 0;
+				
 				DigitT d = 0;
 				
-				for (std::size_t j = (i*8); j < value.size() && j < ((i+1)*8); j += 1) {
-					d = d << 4;			
+				for (std::size_t j = begin; j < end; j += 1) {
+					d = d << 4;
 					d |= convert_to_digit(value[j]);
 				}
 				
-				_value.at(_value.size() - (i+1)) = d;
-			}			
+				_value[i] = d;
+			}
+			
+			normalize();
 		}
 		
 		Integer::Integer(std::string value, BaseT base) {
@@ -274,7 +411,10 @@ namespace Kai {
 		}
 		
 		static std::size_t find_last_set(DigitT digit) {
-			return DIGIT_BITS - __builtin_clz(digit);
+			if (sizeof(DigitT) > sizeof(unsigned))
+				return DIGIT_BITS - __builtin_clzll(digit);
+			else
+				return DIGIT_BITS - __builtin_clz(digit);
 		}
 		
 		std::size_t Integer::bit_size() const
@@ -302,18 +442,18 @@ namespace Kai {
 				_value.resize(a._value.size());
 			}
 			
-			IntermediateT carry = 0;
+			DoubleDigitT carry = 0;
 			std::size_t i = 0;
 			
 			for (; i < a._value.size(); i += 1) {
-				IntermediateT result = (IntermediateT)_value[i] + (IntermediateT)a._value[i] + carry;
+				DoubleDigitT result = (DoubleDigitT)_value[i] + (DoubleDigitT)a._value[i] + carry;
 				
 				_value[i] = (DigitT)result;
 				carry = result >> DIGIT_BITS;
 			}
 			
 			for (;carry != 0 && i < _value.size(); i += 1) {
-				IntermediateT result = (IntermediateT)_value[i] + carry;
+				DoubleDigitT result = (DoubleDigitT)_value[i] + carry;
 				
 				_value[i] = (DigitT)result;
 				carry = result >> DIGIT_BITS;
@@ -324,20 +464,24 @@ namespace Kai {
 			}
 		}
 		
-		void Integer::subtract(const Integer & _a) {
-			Integer a = _a; a.normalize();
-			
+		void Integer::subtract(const Integer & a) {
 			//assert((*this) >= a);
 			//Integer start = *this;
 			
-			std::size_t width = a._value.size();	
-			IntermediateT take = 0;
+			// Ignore any leading zeros, rather than normalizing a copy:
+			std::size_t digits = a._value.size();
+			
+			while (digits > 1 && a._value[digits-1] == 0)
+				digits -= 1;
+			
+			std::size_t width = digits;
+			DoubleDigitT take = 0;
 			
 			for (std::size_t i = 0; i < width; i += 1) {
-				IntermediateT remove = take;
+				DoubleDigitT remove = take;
 				
-				if (i < a._value.size())
-					remove += (IntermediateT)a._value[i];
+				if (i < digits)
+					remove += (DoubleDigitT)a._value[i];
 				
 				if (_value[i] >= remove) {
 					_value[i] -= remove;
@@ -346,7 +490,7 @@ namespace Kai {
 				} else {
 					width = std::max(width, i+2);
 					
-					_value[i] = ((IntermediateT)_value[i] + B) - remove;
+					_value[i] = ((DoubleDigitT)_value[i] + B) - remove;
 					
 					// Take 1 from the next digit
 					take = 1;
@@ -358,412 +502,1360 @@ namespace Kai {
 		}
 		
 		void Integer::multiply(const Integer & other) {
-			Integer a = *this;
-			Integer b = other; // Make a copy of the integer data, to avoid aliasing issues.
-			
-			this->set_product(a, b);
+			this->set_product(*this, other);
+		}
+		
+		void Integer::multiply(const Integer & other, Workspace & workspace) {
+			this->set_product(*this, other, workspace);
 		}
 		
 		void Integer::modulus (const Integer & m) {
-			Integer numerator = *this;
-			Integer result = 0;
+			Integer result;
 			
-			result.set_fraction(numerator, m, *this);
+			// The numerator is copied before the remainder is written, so they can be aliased:
+			result.set_fraction(*this, m, *this);
 		}
 		
-		void Integer::set_product(const Integer & x, const Integer & y) {
-			assert(x.size() != 0);
-			assert(y.size() != 0);
+// MARK: Workspace
+		
+		// The smallest block of digits allocated by a workspace. Each new block is at least twice as big as the previous one, so a workspace only allocates a logarithmic number of times.
+		static const std::size_t WORKSPACE_BLOCK = 256;
+		
+		Workspace::Workspace() : _current(0) {
+		}
+		
+		Workspace::Workspace(const Workspace &) : _current(0) {
+		}
+		
+		DigitT * Workspace::allocate(std::size_t n) {
+			for (; _current < _blocks.size(); _current += 1) {
+				Block & block = _blocks[_current];
+				
+				if (block.used + n <= block.digits.size()) {
+					DigitT * digits = block.digits.data() + block.used;
+					block.used += n;
+					
+					return digits;
+				}
+			}
+			
+			std::size_t size = std::max(n, WORKSPACE_BLOCK);
+			
+			if (!_blocks.empty())
+				size = std::max(size, 2 * _blocks.back().digits.size());
 			
-			std::size_t n = x.size() - 1, t = y.size() - 1;
+			_blocks.push_back(Block());
+			_current = _blocks.size() - 1;
 			
-			//for (std::size_t i = 0; i < _value.size(); i++)
-			//	_value[i] = 0;
+			Block & block = _blocks.back();
+			block.digits.resize(size);
+			block.used = n;
 			
-			memset(&_value[0], 0, _value.size() * sizeof(DigitT));
+			return block.digits.data();
+		}
+		
+		std::size_t Workspace::capacity() const {
+			std::size_t total = 0;
+			
+			for (const Block & block : _blocks)
+				total += block.digits.size();
+			
+			return total;
+		}
+		
+		Workspace::Scope::Scope(Workspace & workspace) : _workspace(workspace), _block(workspace._current), _used(0) {
+			if (_block < _workspace._blocks.size())
+				_used = _workspace._blocks[_block].used;
+		}
+		
+		Workspace::Scope::~Scope() {
+			std::vector<Block> & blocks = _workspace._blocks;
 			
-			std::size_t max_size = x.size() + y.size() + 2;
+			for (std::size_t i = _block + 1; i < blocks.size(); i += 1)
+				blocks[i].used = 0;
 			
-			//if (max_size > 50)
-			//	std::cerr << "Size: " << max_size << std::endl;
+			if (_block < blocks.size())
+				blocks[_block].used = _used;
+			
+			_workspace._current = _block;
+		}
+		
+// MARK: Multiplication
+		
+		// Operands with fewer digits than these are multiplied using the schoolbook method, and those with more using Karatsuba, or Toom-3 for larger operands. See Integer.hpp for the measurements.
+		static const std::size_t KARATSUBA_THRESHOLD = Integer::KARATSUBA_THRESHOLD;
+		static const std::size_t TOOM3_THRESHOLD = Integer::TOOM3_THRESHOLD;
+		static const std::size_t KARATSUBA_SQUARE_THRESHOLD = Integer::KARATSUBA_SQUARE_THRESHOLD;
+		static const std::size_t TOOM3_SQUARE_THRESHOLD = Integer::TOOM3_SQUARE_THRESHOLD;
+		
+		// Smaller operands would be split into parts which are not smaller than the operands themselves:
+		static_assert(KARATSUBA_THRESHOLD >= 4 && KARATSUBA_SQUARE_THRESHOLD >= 4, "Karatsuba threshold is too small!");
+		static_assert(TOOM3_THRESHOLD >= KARATSUBA_THRESHOLD && TOOM3_SQUARE_THRESHOLD >= KARATSUBA_SQUARE_THRESHOLD, "Toom-3 threshold is too small!");
+		
+		typedef std::vector<DigitT> DigitsT;
+		
+		static void multiply_digits(DigitT * r, const DigitT * a, std::size_t na, const DigitT * b, std::size_t nb, Workspace & workspace);
+		static void square_digits(DigitT * r, const DigitT * a, std::size_t n, Workspace & workspace);
+		
+		// The number of digits, ignoring leading zeros.
+		static std::size_t significant_digits(const DigitT * a, std::size_t n) {
+			while (n > 0 && a[n-1] == 0)
+				n -= 1;
 			
-			_value.resize(max_size);
+			return n;
+		}
+		
+		// Adds b to r, where r has at least as many digits as b, and returns the carry.
+		static DigitT add_digits(DigitT * r, std::size_t nr, const DigitT * b, std::size_t nb) {
+			DoubleDigitT carry = 0;
+			std::size_t i = 0;
 			
-			for (std::size_t i = 0; i <= t; i += 1) {
-				IntermediateT carry = 0;
+			for (; i < nb; i += 1) {
+				DoubleDigitT result = (DoubleDigitT)r[i] + (DoubleDigitT)b[i] + carry;
 				
-				for (std::size_t j = 0; j <= n; j++) {
-					IntermediateT product = (IntermediateT)x[j] * (IntermediateT)y[i];
-					IntermediateT result = (IntermediateT)_value[i+j] + product + carry;
-					
-					_value[i+j] = (DigitT)result;
-					carry = result >> DIGIT_BITS;
-				}
+				r[i] = (DigitT)result;
+				carry = result >> DIGIT_BITS;
+			}
+			
+			for (; carry != 0 && i < nr; i += 1) {
+				DoubleDigitT result = (DoubleDigitT)r[i] + carry;
 				
-				_value[i+n+1] = carry;
+				r[i] = (DigitT)result;
+				carry = result >> DIGIT_BITS;
 			}
 			
-			this->normalize();
+			return carry;
 		}
 		
-		struct Shift {
-			Integer count, product;
-		};
-		
-		bool Integer::set_fraction_slow(const Integer & numerator, const Integer & denominator, Integer & remainder) {
-			if (numerator == 0) {
-				remainder = 0;
-				(*this) = 0;
+		// Subtracts b from r, where r has at least as many digits as b, and returns the borrow.
+		static DigitT subtract_digits(DigitT * r, std::size_t nr, const DigitT * b, std::size_t nb) {
+			DoubleDigitT borrow = 0;
+			std::size_t i = 0;
+			
+			for (; i < nb; i += 1) {
+				DoubleDigitT result = (DoubleDigitT)r[i] - (DoubleDigitT)b[i] - borrow;
 				
-				return true; // no remainder
+				r[i] = (DigitT)result;
+				borrow = (result >> DIGIT_BITS) & 1;
 			}
 			
-			if (denominator == 0) {
-				throw std::runtime_error("Division by 0!");
+			for (; borrow != 0 && i < nr; i += 1) {
+				DoubleDigitT result = (DoubleDigitT)r[i] - borrow;
+				
+				r[i] = (DigitT)result;
+				borrow = (result >> DIGIT_BITS) & 1;
 			}
 			
-			(*this) = 0; // Number of divisions possible.
-			Integer accumulator = 0; // Total value of doublings.
+			return borrow;
+		}
+		
+		// Adds the significant digits of b to r at the given offset. The sum must fit in r.
+		static void accumulate_digits(DigitT * r, std::size_t nr, std::size_t offset, const DigitT * b, std::size_t nb) {
+			nb = significant_digits(b, nb);
 			
-			bool top = false;
+			assert(offset + nb <= nr);
 			
-			std::vector<Shift> shifts;
-			// This pair must typically be shifted together.
-			Shift s = {1, denominator};
-			shifts.push_back(s);
+			DigitT carry = add_digits(r + offset, nr - offset, b, nb);
 			
-			std::size_t offset = 0;
+			assert(carry == 0);
+			(void)carry;
+		}
+		
+		// r = a * b, where r has na + nb digits.
+		static void multiply_schoolbook(DigitT * r, const DigitT * a, std::size_t na, const DigitT * b, std::size_t nb) {
+			memset(r, 0, (na + nb) * sizeof(DigitT));
 			
-			while (true) {
-				//std::cout << count << std::endl;
-				Integer tmp = s.product;
-				tmp.add(accumulator);
-				
-				int r = tmp.compare_with(numerator);
+			for (std::size_t i = 0; i < nb; i += 1) {
+				DoubleDigitT carry = 0;
 				
-				if (r == 0) {
-					// We have found a division with no remainder
-					this->add(s.count);
-					//accumulator.add(s.product);
-					remainder = 0;
-					
-					return true;
-				} else if (r == 1) {
-					// We have found a division with a remainder
-					if (offset == 0) {
-						// We have found a divisor with a remainder
-						remainder = numerator;
-						remainder.subtract(accumulator);
-						
-						return false;
-					}
+				for (std::size_t j = 0; j < na; j += 1) {
+					DoubleDigitT result = (DoubleDigitT)a[j] * (DoubleDigitT)b[i] + (DoubleDigitT)r[i+j] + carry;
 					
-					offset -= 1;
-					s = shifts[offset];
-					top = true;
-					
-					continue;
+					r[i+j] = (DigitT)result;
+					carry = result >> DIGIT_BITS;
 				}
 				
-				this->add(s.count);
-				accumulator.add(s.product);
-				
-				if (!top) {
-					offset += 1;
-					
-					//if (offset >= shifts.size()) {
-					s.count.shift_left(1);
-					s.product.shift_left(1);
-					
-					shifts.push_back(s);
-					//} else {
-					//	s = shifts[offset];
-					//}
-				}
+				r[i+na] = carry;
 			}
 		}
 		
-		void Integer::set_fraction(const Integer & numerator, const Integer & denominator, Integer & remainder) {
-			if (numerator < denominator) {
-				(*this) = 0;
-				remainder = numerator;
-				return;
-			}
-			
-			Integer x = numerator;
-			Integer y = denominator;
-			x.normalize();
-			y.normalize();
-			
-			// Normalize?
-			std::size_t shift = 0;
+		// r = a * a, where r has 2n digits. Each product a[i] * a[j] where i != j occurs twice, so it is only calculated once, and the sum is doubled before the squares of the digits are added.
+		static void square_schoolbook(DigitT * r, const DigitT * a, std::size_t n) {
+			memset(r, 0, (2 * n) * sizeof(DigitT));
 			
-			DigitT back = y._value.back();
-			while (back < (B/2)) {
-				back = back << 1;
-				shift += 1;
+			for (std::size_t i = 0; i < n; i += 1) {
+				DoubleDigitT carry = 0;
+				
+				for (std::size_t j = i + 1; j < n; j += 1) {
+					DoubleDigitT result = (DoubleDigitT)a[i] * (DoubleDigitT)a[j] + (DoubleDigitT)r[i+j] + carry;
+					
+					r[i+j] = (DigitT)result;
+					carry = result >> DIGIT_BITS;
+				}
 				
-				assert(back != 0);
+				r[i+n] = carry;
 			}
 			
-			if (shift) {
-				x.shift_left(shift);
-				y.shift_left(shift);
+			// The sum of the products is less than half of the square, so doubling it can't overflow:
+			DigitT overflow = 0;
+			
+			for (std::size_t i = 0; i < 2 * n; i += 1) {
+				DigitT digit = r[i];
+				
+				r[i] = (digit << 1) | overflow;
+				overflow = digit >> (DIGIT_BITS - 1);
 			}
 			
-			set_fraction(x, y);
+			DoubleDigitT carry = 0;
 			
-			if (shift) {
-				x.shift_right(shift);
+			for (std::size_t i = 0; i < n; i += 1) {
+				DoubleDigitT square = (DoubleDigitT)a[i] * (DoubleDigitT)a[i];
+				
+				DoubleDigitT result = (DoubleDigitT)r[2*i] + (DigitT)square + carry;
+				r[2*i] = (DigitT)result;
+				carry = result >> DIGIT_BITS;
+				
+				result = (DoubleDigitT)r[2*i+1] + (square >> DIGIT_BITS) + carry;
+				r[2*i+1] = (DigitT)result;
+				carry = result >> DIGIT_BITS;
 			}
-			/*
-			 Integer c;
-			 c.set_product(*this, denominator);
-			 c.add(x); // remainder
-			 
-			 // Check the result is correct
-			 assert(x < denominator);
-			 assert(numerator == c);
-			 */
-			remainder = x;
-			remainder.normalize();
 		}
 		
-		/*void Integer::trim() {
-		 std::size_t non_zero = _value.size() - 1;
-		 
-		 while (non_zero > 0 && _value[non_zero] == 0) {
-		 non_zero -= 1;
-		 }
-		 
-		 _value.resize(non_zero + 1);
-		 }*/
-		
-		void Integer::set_fraction(Integer & x, Integer y) {
-			// The number of digits in the result
-			const std::size_t n = x.size() - 1;
-			const std::size_t t = y.size() - 1;
+		// r = a * b, where na >= nb > na / 2. With a = a1 * B^h + a0 and b = b1 * B^h + b0, the middle term a1 * b0 + a0 * b1 is (a0 + a1)(b0 + b1) - a0 * b0 - a1 * b1, so only three half sized products are required.
+		static void multiply_karatsuba(DigitT * r, const DigitT * a, std::size_t na, const DigitT * b, std::size_t nb, Workspace & workspace) {
+			const std::size_t h = (na + 1) / 2, na1 = na - h, nb1 = nb - h;
+			
+			// The low and high products are stored directly in the result:
+			multiply_digits(r, a, h, b, h, workspace);
+			multiply_digits(r + 2*h, a + h, na1, b + h, nb1, workspace);
+			
+			Workspace::Scope scope(workspace);
+			
+			DigitT * sa = workspace.allocate(h + 1), * sb = workspace.allocate(h + 1);
+			std::copy(a, a + h, sa);
+			std::copy(b, b + h, sb);
+			sa[h] = add_digits(sa, h, a + h, na1);
+			sb[h] = add_digits(sb, h, b + h, nb1);
+			
+			const std::size_t nm = 2 * (h + 1);
+			DigitT * middle = workspace.allocate(nm);
+			multiply_digits(middle, sa, h + 1, sb, h + 1, workspace);
 			
-			assert(n >= t);
-			assert(t >= 0);
-			assert(y[t] != 0);
+			subtract_digits(middle, nm, r, 2*h);
+			subtract_digits(middle, nm, r + 2*h, na1 + nb1);
 			
-			// numerator is smaller than denominator, done.
-			if (n < t) return;
+			accumulate_digits(r, na + nb, h, middle, nm);
+		}
+		
+		static void square_karatsuba(DigitT * r, const DigitT * a, std::size_t n, Workspace & workspace) {
+			const std::size_t h = (n + 1) / 2, n1 = n - h;
 			
-			const std::size_t nt = n - t;
+			square_digits(r, a, h, workspace);
+			square_digits(r + 2*h, a + h, n1, workspace);
 			
-			Integer & q = *this;
+			Workspace::Scope scope(workspace);
 			
-			q._value.clear();
-			q._value.resize(nt+1);
+			DigitT * sa = workspace.allocate(h + 1);
+			std::copy(a, a + h, sa);
+			sa[h] = add_digits(sa, h, a + h, n1);
 			
-			// Base (radix)
-			Integer bb; bb.set_product(B, B);
-			Integer bp; bp.set_power(B, nt);
+			const std::size_t nm = 2 * (h + 1);
+			DigitT * middle = workspace.allocate(nm);
+			square_digits(middle, sa, h + 1, workspace);
 			
-			Integer tmp1, tmp2;
+			subtract_digits(middle, nm, r, 2*h);
+			subtract_digits(middle, nm, r + 2*h, 2*n1);
 			
-			if (y[t] < (B/2)) {
-				std::cerr << "Thar be the dragons!" << std::endl;
+			accumulate_digits(r, 2*n, h, middle, nm);
+		}
+		
+		// A signed value used for the evaluation and interpolation of Toom-3, which has intermediate values which may be negative. The digits are allocated from a workspace, with enough capacity for every intermediate value.
+		struct SignedDigits {
+			DigitT * digits;
+			std::size_t size, capacity;
+			bool negative;
+			
+			void allocate(Workspace & workspace, std::size_t n) {
+				digits = workspace.allocate(n);
+				size = 0;
+				capacity = n;
+				negative = false;
 			}
 			
-			tmp1.set_product(y, bp);
-			while (x >= tmp1) {
-				q[nt] += 1;
-				x.subtract(tmp1);
+			void assign(const DigitT * b, std::size_t nb, bool b_negative = false) {
+				assert(nb <= capacity);
+				
+				std::copy(b, b + nb, digits);
+				size = nb;
+				negative = b_negative;
 			}
 			
-			for (std::size_t i = n; i > t; i--) {		
-				if (x[i] == y[t]) {
-					q[i-t-1] = B - 1;
-				} else {
-					IntermediateT t1 = (IntermediateT)x[i] * B;
-					if (i > 0) t1 += x[i-1];
-					q[i-t-1] = t1 / (IntermediateT)y[t];
-				}
+			void assign(const SignedDigits & other) {
+				assign(other.digits, other.size, other.negative);
+			}
+			
+			// this = this + (-1)^b_negative * b
+			void add(const DigitT * b, std::size_t nb, bool b_negative) {
+				std::size_t n = significant_digits(digits, size);
+				std::size_t m = significant_digits(b, nb);
 				
-				// If we had 128 bit arithmetic, we could do this on the CPU.
-				Integer u;
-				u.set_product(y[t], B);
-				if (t > 0) u.add(y[t-1]);
-				
-				Integer v;
-				v.set_product(x[i], bb);
-				if (i > 0) { tmp1.set_product(x[i-1], B); v.add(tmp1); }
-				if (i > 1) v.add(x[i-2]);
-				
-				while (true) {
-					tmp1.set_product(q[i-t-1], u);
-					if (tmp1 > v) {
-						q[i-t-1] -= 1;
-					} else {
-						break;
+				if (negative == b_negative) {
+					assert(std::max(n, m) < capacity);
+					
+					if (n < m)
+						std::fill(digits + n, digits + m, 0);
+					
+					size = std::max(n, m);
+					digits[size] = add_digits(digits, size, b, m);
+					size += 1;
+				} else if (compare(digits, n, b, m) >= 0) {
+					subtract_digits(digits, n, b, m);
+					size = n;
+				} else {
+					// this = b - this, calculated in place:
+					DoubleDigitT borrow = 0;
+					
+					for (std::size_t i = 0; i < m; i += 1) {
+						DoubleDigitT result = (DoubleDigitT)b[i] - (i < n ? digits[i] : 0) - borrow;
+						
+						digits[i] = (DigitT)result;
+						borrow = (result >> DIGIT_BITS) & 1;
 					}
+					
+					assert(borrow == 0);
+					
+					size = m;
+					negative = b_negative;
 				}
+			}
+			
+			// this = this + (-1)^negate * other
+			void add(const SignedDigits & other, bool negate = false) {
+				add(other.digits, other.size, other.negative != negate);
+			}
+			
+			void multiply(DigitT factor) {
+				DoubleDigitT carry = 0;
 				
-				// Because B is 0x1_0000_0000, we can use a simple shift rather than power calculation.
-				//tmp1.set_power(B, i-t-1);
-				tmp1 = 1;
-				tmp1.shift_left_digits(i-t-1);
+				for (std::size_t i = 0; i < size; i += 1) {
+					DoubleDigitT result = (DoubleDigitT)digits[i] * factor + carry;
+					
+					digits[i] = (DigitT)result;
+					carry = result >> DIGIT_BITS;
+				}
 				
-				tmp2.set_product(y, tmp1);
-				tmp1.set_product(q[i-t-1], tmp2);
+				if (carry) {
+					assert(size < capacity);
+					digits[size++] = carry;
+				}
+			}
+			
+			// The division must be exact.
+			void divide(DigitT divisor) {
+				DoubleDigitT remainder = 0;
 				
-				if (tmp1 > x) {
-					x.add(tmp2);
-					x.subtract(tmp1);
-					q[i-t-1] -= 1;
-				} else {
-					x.subtract(tmp1);
+				for (std::size_t i = size; i > 0; i -= 1) {
+					DoubleDigitT value = (remainder << DIGIT_BITS) | digits[i-1];
+					
+					digits[i-1] = (DigitT)(value / divisor);
+					remainder = value % divisor;
 				}
+				
+				assert(remainder == 0);
 			}
 			
-			// Removing any preceeding zeros:
-			q.normalize();
-		}
-		
-		// For a given number in a given base, return the fractional part of the given size.
-		// e.g. for 1052341, given base 10 and scale = 4, return 2341.
-		Integer Integer::fractional_part(ScaleT scale, const Integer & base) {
-			Integer copy = *this, fraction = 0, place = 1;
+			static int compare(const DigitT * a, std::size_t na, const DigitT * b, std::size_t nb) {
+				if (na != nb)
+					return na < nb ? -1 : 1;
+				
+				for (std::size_t i = na; i > 0; i -= 1) {
+					if (a[i-1] != b[i-1])
+						return a[i-1] < b[i-1] ? -1 : 1;
+				}
+				
+				return 0;
+			}
 			
-			while (!copy.is_zero() && scale > 0) {
-				Integer result, remainder;
+			void set_product(const SignedDigits & x, const SignedDigits & y, bool square, Workspace & workspace) {
+				std::size_t n = significant_digits(x.digits, x.size);
+				std::size_t m = significant_digits(y.digits, y.size);
 				
-				result.set_fraction(copy, base, remainder);
+				size = 0;
+				negative = false;
 				
-				remainder.multiply(place);
-				place.multiply(base);
+				if (n == 0 || m == 0)
+					return;
 				
-				fraction.add(remainder);
+				assert(n + m <= capacity);
 				
-				result.swap(copy);
+				if (square)
+					square_digits(digits, x.digits, n, workspace);
+				else
+					multiply_digits(digits, x.digits, n, y.digits, m, workspace);
 				
-				scale -= 1;
+				size = n + m;
+				negative = x.negative != y.negative;
 			}
-			
-			return fraction;
-		}
-		
-// MARK: Modular Exponentiation
+		};
 		
-		BarrettReduction::BarrettReduction (const Integer & _mod) {
-			mod = _mod;
-			mod.normalize();
+		// The polynomial a2 * x^2 + a1 * x + a0 where x = B^k, evaluated at 0, 1, -1, -2 and infinity.
+		static void evaluate_toom3(const DigitT * a, std::size_t na, std::size_t k, SignedDigits points[5]) {
+			const DigitT * a0 = a, * a1 = a + k, * a2 = a + 2*k;
+			const std::size_t n2 = na - 2*k;
 			
-			// Remainder - temporary.
-			Integer r;
+			// p(1) = a0 + a2 + a1
+			points[1].assign(a0, k);
+			points[1].add(a2, n2, false);
 			
-			// Radix - the number of possible values per digit
-			b = (IntermediateT)1 << DIGIT_BITS;
-			bk.set_power(b, mod.size() * 2);
-			mu.set_fraction(bk, mod, r);
+			// p(-1) = a0 + a2 - a1
+			points[2].assign(points[1]);
+			points[2].add(a1, k, true);
 			
-			// Division by 0x100 is the same as shift_right(2)
-			bn = DIGIT_BITS * (mod.size() - 1);
-			bp = DIGIT_BITS * (mod.size() + 1);
+			points[1].add(a1, k, false);
 			
-			// Mask for base-2 modulus
-			bkp.set_power(b, mod.size() + 1);
-			bkm = bkp;
-			bkm.subtract(1);
+			// p(-2) = 2 * (p(-1) + a2) - a0
+			points[3].assign(points[2]);
+			points[3].add(a2, n2, false);
+			points[3].multiply(2);
+			points[3].add(a0, k, true);
+			
+			points[0].assign(a0, k);
+			points[4].assign(a2, n2);
 		}
 		
-		void BarrettReduction::modulus (Integer & x) const {
-			Integer q1, q2, q3, r1, r2;
-			
-			q1 = x;
-			q1.shift_right(bn);
+		// r = a * b, where na >= nb > 2 * ceil(na / 3). Each operand is split into three parts, and the product of the polynomials is interpolated from five pointwise products, using the sequence given by Bodrato.
+		static void multiply_toom3(DigitT * r, const DigitT * a, std::size_t na, const DigitT * b, std::size_t nb, bool square, Workspace & workspace) {
+			const std::size_t k = (na + 2) / 3;
 			
-			//q2.set_product(q1, mu);
+			Workspace::Scope scope(workspace);
 			
-			//q3 = q2;
-			q3.set_product(q1, mu);
-			q3.shift_right(bp);
+			// Each point is at most 7 * B^k, and each product and interpolated value is less than B^(2k + 4):
+			SignedDigits p[5], q[5], w[5];
+			
+			for (std::size_t i = 0; i < 5; i += 1) {
+				p[i].allocate(workspace, k + 3);
+				
+				if (!square)
+					q[i].allocate(workspace, k + 3);
+				
+				w[i].allocate(workspace, 2*k + 6);
+			}
+			
+			evaluate_toom3(a, na, k, p);
+			
+			if (!square)
+				evaluate_toom3(b, nb, k, q);
+			
+			for (std::size_t i = 0; i < 5; i += 1) {
+				w[i].set_product(p[i], square ? p[i] : q[i], square, workspace);
+			}
+			
+			// w3 = (w(-2) - w(1)) / 3
+			w[3].add(w[1], true);
+			w[3].divide(3);
+			
+			// w1 = (w(1) - w(-1)) / 2
+			w[1].add(w[2], true);
+			w[1].divide(2);
+			
+			// w2 = w(-1) - w(0)
+			w[2].add(w[0], true);
+			
+			// w3 = (w2 - w3) / 2 + 2 * w(inf)
+			w[3].negative = !w[3].negative;
+			w[3].add(w[2]);
+			w[3].divide(2);
+			w[3].add(w[4]);
+			w[3].add(w[4]);
+			
+			// w2 = w2 + w1 - w(inf)
+			w[2].add(w[1]);
+			w[2].add(w[4], true);
+			
+			// w1 = w1 - w3
+			w[1].add(w[3], true);
+			
+			memset(r, 0, (na + nb) * sizeof(DigitT));
+			
+			for (std::size_t i = 0; i < 5; i += 1) {
+				assert(!w[i].negative || significant_digits(w[i].digits, w[i].size) == 0);
+				
+				accumulate_digits(r, na + nb, i * k, w[i].digits, w[i].size);
+			}
+		}
+		
+		// r = a * b, where r has na + nb digits.
+		static void multiply_digits(DigitT * r, const DigitT * a, std::size_t na, const DigitT * b, std::size_t nb, Workspace & workspace) {
+			if (na < nb) {
+				std::swap(a, b);
+				std::swap(na, nb);
+			}
+			
+			if (a == b && na == nb) {
+				square_digits(r, a, na, workspace);
+			} else if (nb < KARATSUBA_THRESHOLD) {
+				multiply_schoolbook(r, a, na, b, nb);
+			} else if (na >= 2 * nb) {
+				// Unbalanced operands are multiplied in pieces the size of the smaller one:
+				memset(r, 0, (na + nb) * sizeof(DigitT));
+				
+				Workspace::Scope scope(workspace);
+				DigitT * piece = workspace.allocate(2 * nb);
+				
+				for (std::size_t offset = 0; offset < na; offset += nb) {
+					std::size_t n = std::min(nb, na - offset);
+					
+					multiply_digits(piece, a + offset, n, b, nb, workspace);
+					accumulate_digits(r, na + nb, offset, piece, n + nb);
+				}
+			} else if (nb >= TOOM3_THRESHOLD && nb > 2 * ((na + 2) / 3)) {
+				multiply_toom3(r, a, na, b, nb, false, workspace);
+			} else {
+				multiply_karatsuba(r, a, na, b, nb, workspace);
+			}
+		}
+		
+		// r = a * a, where r has 2n digits.
+		static void square_digits(DigitT * r, const DigitT * a, std::size_t n, Workspace & workspace) {
+			if (n < KARATSUBA_SQUARE_THRESHOLD) {
+				square_schoolbook(r, a, n);
+			} else if (n >= TOOM3_SQUARE_THRESHOLD) {
+				multiply_toom3(r, a, n, a, n, true, workspace);
+			} else {
+				square_karatsuba(r, a, n, workspace);
+			}
+		}
+		
+		void Integer::set_product(const Integer & x, const Integer & y) {
+			Workspace workspace;
+			
+			set_product(x, y, workspace);
+		}
+		
+		void Integer::set_product(const Integer & x, const Integer & y, Workspace & workspace) {
+			assert(x.size() != 0);
+			assert(y.size() != 0);
+			
+			// Leading zeros don't contribute to the product, but would make it more expensive:
+			std::size_t n = std::max<std::size_t>(significant_digits(x._value.data(), x.size()), 1);
+			std::size_t t = std::max<std::size_t>(significant_digits(y._value.data(), y.size()), 1);
+			
+			Workspace::Scope scope(workspace);
+			
+			const DigitT * a = x._value.data(), * b = y._value.data();
+			
+			// The product is calculated in place, which would overwrite an aliased operand, so it is copied first:
+			if (&x == this || &y == this) {
+				DigitT * copy = workspace.allocate(n);
+				std::copy(_value.begin(), _value.begin() + n, copy);
+				
+				if (&x == this) a = copy;
+				if (&y == this) b = copy;
+			}
+			
+			_value.resize(n + t);
+			
+			multiply_digits(_value.data(), a, n, b, t, workspace);
+			
+			this->normalize();
+		}
+		
+// MARK: Sums and Products
+		
+		void Integer::set_sum(const Integer * const * operands, std::size_t count, Workspace & workspace) {
+			std::size_t n = 0;
+			
+			for (std::size_t i = 0; i < count; i += 1)
+				n = std::max(n, significant_digits(operands[i]->_value.data(), operands[i]->size()));
+			
+			Workspace::Scope scope(workspace);
+			
+			// Each digit of the sum is accumulated in two digits, the low digit and the number of times it overflowed, which can't overflow itself unless there are at least B operands:
+			DigitT * low = workspace.allocate(n + 1), * high = workspace.allocate(n);
+			std::fill(low, low + n + 1, 0);
+			std::fill(high, high + n, 0);
+			
+			for (std::size_t i = 0; i < count; i += 1) {
+				const DigitT * digits = operands[i]->_value.data();
+				std::size_t m = significant_digits(digits, operands[i]->size());
+				
+				for (std::size_t j = 0; j < m; j += 1) {
+					low[j] += digits[j];
+					high[j] += (low[j] < digits[j]);
+				}
+			}
+			
+			// Each overflow is worth one in the next digit:
+			DigitT carry = add_digits(low + 1, n, high, n);
+			
+			assert(carry == 0);
+			(void)carry;
+			
+			_value.resize(n + 1);
+			std::copy(low, low + n + 1, _value.begin());
+			
+			this->normalize();
+		}
+		
+		// The number of digits of the operand, ignoring leading zeros, but at least one.
+		static std::size_t operand_digits(const Integer * operand) {
+			return std::max<std::size_t>(significant_digits(operand->value().data(), operand->size()), 1);
+		}
+		
+		// r = the product of the operands, where r has as many digits as all of the operands together. Returns the number of significant digits in r, which is at least one.
+		static std::size_t multiply_tree(DigitT * r, const Integer * const * operands, std::size_t count, std::size_t total, Workspace & workspace) {
+			if (count == 1) {
+				const DigitT * digits = operands[0]->value().data();
+				std::copy(digits, digits + total, r);
+				
+				return total;
+			}
+			
+			// Split the operands so that the first half has at most half of the digits, but at least one operand:
+			std::size_t m = 1, left = operand_digits(operands[0]);
+			
+			while (m < count - 1 && 2 * (left + operand_digits(operands[m])) <= total) {
+				left += operand_digits(operands[m]);
+				m += 1;
+			}
+			
+			Workspace::Scope scope(workspace);
+			
+			DigitT * a = workspace.allocate(left), * b = workspace.allocate(total - left);
+			
+			std::size_t na = multiply_tree(a, operands, m, left, workspace);
+			std::size_t nb = multiply_tree(b, operands + m, count - m, total - left, workspace);
+			
+			multiply_digits(r, a, na, b, nb, workspace);
+			
+			return std::max<std::size_t>(significant_digits(r, na + nb), 1);
+		}
+		
+		void Integer::set_product(const Integer * const * operands, std::size_t count, Workspace & workspace) {
+			if (count == 0) {
+				(*this) = 1;
+				return;
+			}
+			
+			std::size_t total = 0;
+			
+			for (std::size_t i = 0; i < count; i += 1)
+				total += operand_digits(operands[i]);
+			
+			Workspace::Scope scope(workspace);
+			
+			DigitT * r = workspace.allocate(total);
+			std::size_t n = multiply_tree(r, operands, count, total, workspace);
+			
+			_value.resize(n);
+			std::copy(r, r + n, _value.begin());
+			
+			this->normalize();
+		}
+		
+// MARK: Division
+		
+		// Divisors with fewer digits than this are divided using long division, and larger ones are divided recursively, so that most of the work is done by the fast multiplication.
+		static const std::size_t BURNIKEL_ZIEGLER_THRESHOLD = Integer::BURNIKEL_ZIEGLER_THRESHOLD;
+		
+		// Subtracts b * factor from r, where r has nb + 1 digits, and returns true if the result was negative, in which case r wraps around.
+		static bool multiply_subtract_digits(DigitT * r, const DigitT * b, std::size_t nb, DigitT factor) {
+			DoubleDigitT carry = 0, borrow = 0;
+			
+			for (std::size_t i = 0; i < nb; i += 1) {
+				DoubleDigitT product = (DoubleDigitT)b[i] * factor + carry;
+				carry = product >> DIGIT_BITS;
+				
+				DoubleDigitT result = (DoubleDigitT)r[i] - (DigitT)product - borrow;
+				r[i] = (DigitT)result;
+				borrow = (result >> DIGIT_BITS) & 1;
+			}
+			
+			DoubleDigitT result = (DoubleDigitT)r[nb] - carry - borrow;
+			r[nb] = (DigitT)result;
+			
+			return (result >> DIGIT_BITS) & 1;
+		}
+		
+		// Divides the nx digits of x by the ny digits of y using Knuth's algorithm D, where y is normalized so that its top bit is set. The low nx - ny digits of the quotient are stored in q, and the most significant digit, which is at most one, is returned. The remainder is left in the low ny digits of x, and the rest of x is zeroed.
+		static DigitT divide_schoolbook(DigitT * q, DigitT * x, std::size_t nx, const DigitT * y, std::size_t ny) {
+			const std::size_t nq = nx - ny;
+			const std::size_t t = ny - 1;
+			
+			assert(nx >= ny);
+			assert(y[t] >= B/2);
+			
+			DigitT most_significant = 0;
+			
+			// The divisor is normalized, so the most significant digit of the quotient is at most one:
+			if (SignedDigits::compare(x + nq, ny, y, ny) >= 0) {
+				subtract_digits(x + nq, ny, y, ny);
+				most_significant = 1;
+			}
+			
+			for (std::size_t i = nx - 1; i > t; i -= 1) {
+				// Estimate the quotient digit from the top two digits of x:
+				DoubleDigitT top = ((DoubleDigitT)x[i] << DIGIT_BITS) | x[i-1];
+				DoubleDigitT estimate = (x[i] == y[t]) ? B - 1 : top / y[t];
+				DoubleDigitT remainder = top - estimate * y[t];
+				
+				// Refine the estimate using the next digit of each, after which it is at most one too big. The top digit of y is at least B/2, so this happens at most twice:
+				if (t > 0) {
+					while (remainder < B && estimate * y[t-1] > ((remainder << DIGIT_BITS) | x[i-2])) {
+						estimate -= 1;
+						remainder += y[t];
+					}
+				}
+				
+				// Subtract the multiple of y from the digits of x at the same offset, and add y back if the estimate was one too big:
+				if (multiply_subtract_digits(x + (i-t-1), y, ny, estimate)) {
+					add_digits(x + (i-t-1), ny + 1, y, ny);
+					estimate -= 1;
+				}
+				
+				q[i-t-1] = estimate;
+			}
+			
+			return most_significant;
+		}
+		
+		static void divide_two_by_one(DigitT * q, DigitT * a, const DigitT * b, std::size_t n, Workspace & workspace);
+		
+		// Divides the 3h digits of a by the 2h digits of b, where a < b * B^h and b is normalized. The h digit quotient is stored in q, and the remainder is left in the low 2h digits of a.
+		static void divide_three_by_two(DigitT * q, DigitT * a, const DigitT * b, std::size_t h, Workspace & workspace) {
+			const DigitT * b1 = b + h;
+			
+			// Estimate the quotient by dividing the top 2h digits of a by the top h digits of b, which gives a result which is at most two too big:
+			if (SignedDigits::compare(a + 2*h, h, b1, h) < 0) {
+				divide_two_by_one(q, a + h, b1, h, workspace);
+			} else {
+				// The top h digits of a and b are equal, so the estimate is B^h - 1, and the remainder is a - b1 * B^h + b1:
+				std::fill(q, q + h, ~(DigitT)0);
+				
+				subtract_digits(a + 2*h, h, b1, h);
+				add_digits(a + h, 2*h, b1, h);
+			}
+			
+			// Subtract the estimate multiplied by the low h digits of b, adding b back while the result is negative:
+			Workspace::Scope scope(workspace);
+			
+			DigitT * product = workspace.allocate(2 * h);
+			multiply_digits(product, q, h, b, h, workspace);
+			
+			DigitT borrow = subtract_digits(a, 3*h, product, 2*h);
+			
+			while (borrow) {
+				const DigitT one = 1;
+				subtract_digits(q, h, &one, 1);
+				
+				borrow -= add_digits(a, 3*h, b, 2*h);
+			}
+		}
+		
+		// Divides the 2n digits of a by the n digits of b, where a < b * B^n and b is normalized. The n digit quotient is stored in q, and the remainder is left in the low n digits of a.
+		static void divide_two_by_one(DigitT * q, DigitT * a, const DigitT * b, std::size_t n, Workspace & workspace) {
+			if (n % 2 || n < BURNIKEL_ZIEGLER_THRESHOLD) {
+				DigitT most_significant = divide_schoolbook(q, a, 2*n, b, n);
+				
+				assert(most_significant == 0);
+				(void)most_significant;
+			} else {
+				const std::size_t h = n / 2;
+				
+				divide_three_by_two(q + h, a + h, b, h, workspace);
+				divide_three_by_two(q, a, b, h, workspace);
+			}
+		}
+		
+		// Divides the nx digits of x by the ny digits of y, where y is normalized so that its top bit is set. The nx - ny + 1 digit quotient is stored in q, and the remainder is left in the low ny digits of x.
+		static void divide_digits(DigitT * q, DigitT * x, std::size_t nx, const DigitT * y, std::size_t ny, Workspace & workspace) {
+			assert(nx >= ny);
+			assert(y[ny-1] >= B/2);
+			
+			if (ny < BURNIKEL_ZIEGLER_THRESHOLD || nx - ny < BURNIKEL_ZIEGLER_THRESHOLD) {
+				q[nx - ny] = divide_schoolbook(q, x, nx, y, ny);
+				
+				return;
+			}
+			
+			// Pad the divisor with zero digits so that it has m = j * 2^k digits, where j is less than the threshold, so that it can be halved k times:
+			std::size_t j = ny, k = 0;
+			
+			while (j >= BURNIKEL_ZIEGLER_THRESHOLD) {
+				j = (j + 1) / 2;
+				k += 1;
+			}
+			
+			const std::size_t m = j << k;
+			const std::size_t s = m - ny;
+			
+			// The dividend is padded in the same way, and split into blocks of m digits. The most significant block has fewer than m significant digits, so it is less than the divisor:
+			const std::size_t blocks = (nx + s) / m + 1;
+			
+			Workspace::Scope scope(workspace);
+			
+			DigitT * a = workspace.allocate(blocks * m), * b = workspace.allocate(m), * z = workspace.allocate(2 * m);
+			DigitT * quotient = workspace.allocate((blocks - 1) * m);
+			
+			std::fill(a, a + s, 0);
+			std::copy(x, x + nx, a + s);
+			std::fill(a + s + nx, a + blocks * m, 0);
+			
+			std::fill(b, b + s, 0);
+			std::copy(y, y + ny, b + s);
+			
+			// Each block is divided along with the remainder from the block above it:
+			std::copy(a + (blocks - 1) * m, a + blocks * m, z + m);
+			
+			for (std::size_t i = blocks - 1; i > 0; i -= 1) {
+				std::copy(a + (i-1) * m, a + i * m, z);
+				
+				divide_two_by_one(quotient + (i-1) * m, z, b, m, workspace);
+				
+				std::copy(z, z + m, z + m);
+			}
+			
+			// The quotient is less than B^(nx - ny + 1), so the padding only added zero digits to it:
+			const std::size_t nq = std::min((blocks - 1) * m, nx - ny + 1);
+			
+			assert(significant_digits(quotient, (blocks - 1) * m) <= nx - ny + 1);
+			
+			std::copy(quotient, quotient + nq, q);
+			std::fill(q + nq, q + (nx - ny + 1), 0);
+			
+			// The remainder was padded along with the dividend and divisor:
+			std::copy(z + m + s, z + 2 * m, x);
+		}
+		
+		// r = a << shift, where shift is less than the number of bits in a digit, and r has n digits. Returns the bits shifted out of the top digit.
+		static DigitT shift_digits_left(DigitT * r, const DigitT * a, std::size_t n, std::size_t shift) {
+			if (shift == 0) {
+				std::copy(a, a + n, r);
+				
+				return 0;
+			}
+			
+			DigitT carry = 0;
+			
+			for (std::size_t i = 0; i < n; i += 1) {
+				DigitT digit = a[i];
+				
+				r[i] = (digit << shift) | carry;
+				carry = digit >> (DIGIT_BITS - shift);
+			}
+			
+			return carry;
+		}
+		
+		// r = a >> shift, where shift is less than the number of bits in a digit, and r has n digits.
+		static void shift_digits_right(DigitT * r, const DigitT * a, std::size_t n, std::size_t shift) {
+			if (shift == 0) {
+				std::copy(a, a + n, r);
+				
+				return;
+			}
+			
+			for (std::size_t i = 0; i < n; i += 1) {
+				DigitT next = (i + 1 < n) ? a[i+1] : 0;
+				
+				r[i] = (a[i] >> shift) | (next << (DIGIT_BITS - shift));
+			}
+		}
+		
+		bool Integer::set_fraction_slow(const Integer & numerator, const Integer & denominator, Integer & remainder) {
+			set_fraction(numerator, denominator, remainder);
+			
+			return remainder.is_zero();
+		}
+		
+		void Integer::set_fraction(const Integer & numerator, const Integer & denominator, Integer & remainder) {
+			Workspace workspace;
+			
+			set_fraction(numerator, denominator, remainder, workspace);
+		}
+		
+		void Integer::set_fraction(const Integer & numerator, const Integer & denominator, Integer & remainder, Workspace & workspace) {
+			if (denominator.is_zero()) {
+				throw std::runtime_error("Division by 0!");
+			}
+			
+			if (numerator < denominator) {
+				remainder = numerator;
+				(*this) = 0;
+				return;
+			}
+			
+			const std::size_t nx = significant_digits(numerator._value.data(), numerator.size());
+			const std::size_t ny = significant_digits(denominator._value.data(), denominator.size());
+			
+			// The operands are copied into the workspace before the quotient and remainder are written, so they can be aliased:
+			Workspace::Scope scope(workspace);
+			
+			DigitT * x = workspace.allocate(nx + 1);
+			
+			// A single digit divisor doesn't need to be normalized, and is much cheaper to divide by:
+			if (ny == 1) {
+				DigitT divisor = denominator[0];
+				
+				std::copy(numerator._value.begin(), numerator._value.begin() + nx, x);
+				DigitT rest = divide_digit(x, nx, divisor);
+				
+				_value.resize(nx);
+				std::copy(x, x + nx, _value.begin());
+				this->normalize();
+				
+				remainder = rest;
+				return;
+			}
+			
+			// Normalize the divisor so that its top bit is set, which keeps the estimates of each quotient digit close to the real value:
+			const std::size_t shift = DIGIT_BITS - find_last_set(denominator[ny-1]);
+			
+			DigitT * y = workspace.allocate(ny);
+			shift_digits_left(y, denominator._value.data(), ny, shift);
+			
+			// The shifted dividend only needs another digit if bits were shifted out of the top:
+			std::size_t n = nx;
+			x[nx] = shift_digits_left(x, numerator._value.data(), nx, shift);
+			
+			if (x[nx] != 0)
+				n += 1;
+			
+			DigitT * q = workspace.allocate(n - ny + 1);
+			divide_digits(q, x, n, y, ny, workspace);
+			
+			_value.resize(n - ny + 1);
+			std::copy(q, q + (n - ny + 1), _value.begin());
+			this->normalize();
+			
+			remainder._value.resize(ny);
+			shift_digits_right(remainder._value.data(), x, ny, shift);
+			remainder.normalize();
+		}
+		
+		// For a given number in a given base, return the fractional part of the given size.
+		// e.g. for 1052341, given base 10 and scale = 4, return 2341.
+		Integer Integer::fractional_part(ScaleT scale, const Integer & base) {
+			Integer copy = *this, fraction = 0, place = 1;
+			
+			while (!copy.is_zero() && scale > 0) {
+				Integer result, remainder;
+				
+				result.set_fraction(copy, base, remainder);
+				
+				remainder.multiply(place);
+				place.multiply(base);
+				
+				fraction.add(remainder);
+				
+				result.swap(copy);
+				
+				scale -= 1;
+			}
+			
+			return fraction;
+		}
+		
+// MARK: Modular Exponentiation
+		
+		BarrettReduction::BarrettReduction (const Integer & _mod) {
+			mod = _mod;
+			mod.normalize();
+			
+			// Remainder - temporary.
+			Integer r;
+			
+			// Radix - the number of possible values per digit
+			b = 1;
+			b.shift_left_digits(1);
+			bk.set_power(b, mod.size() * 2);
+			mu.set_fraction(bk, mod, r);
+			
+			// Division by 0x100 is the same as shift_right(2)
+			bn = DIGIT_BITS * (mod.size() - 1);
+			bp = DIGIT_BITS * (mod.size() + 1);
+			
+			// Mask for base-2 modulus
+			bkp.set_power(b, mod.size() + 1);
+			bkm = bkp;
+			bkm.subtract(1);
+		}
+		
+		void BarrettReduction::modulus (Integer & x) const {
+			Integer q1, q2, q3, r1, r2;
+			
+			q1 = x;
+			q1.shift_right(bn);
+			
+			//q2.set_product(q1, mu);
+			
+			//q3 = q2;
+			q3.set_product(q1, mu);
+			q3.shift_right(bp);
 			
 			//r1 = x;
 			//r1.binary_and(bkm);
 			x.binary_and(bkm);
 			
-			r2.set_product(q3, mod);
-			r2.binary_and(bkm);
+			r2.set_product(q3, mod);
+			r2.binary_and(bkm);
+			
+			if (r2 > x) {
+				x.add(bkp);
+			}
+			
+			x.subtract(r2);
+			
+			while (x >= mod) {
+				x.subtract(mod);
+			}
+			
+			//x = r1;
+			x.normalize();
+		}
+		
+		// Products of moduli up to 4096 bits are reduced without allocating any memory:
+		typedef InlineVector<DigitT, 2 * (4096 / DIGIT_BITS) + 1> WorkspaceT;
+		
+		// Computes T * R^-1 mod m, where T has 2n + 1 digits and is less than m * R. The result is stored in the top n + 1 digits of T.
+		static void reduce_montgomery(DigitT * t, const DigitT * m, std::size_t n, DigitT inverse) {
+			for (std::size_t i = 0; i < n; i += 1) {
+				// Adding q * m makes digit i zero:
+				DigitT q = t[i] * inverse;
+				DoubleDigitT carry = 0;
+				
+				for (std::size_t j = 0; j < n; j += 1) {
+					DoubleDigitT result = (DoubleDigitT)q * m[j] + t[i+j] + carry;
+					
+					t[i+j] = (DigitT)result;
+					carry = result >> DIGIT_BITS;
+				}
+				
+				for (std::size_t j = i + n; carry != 0; j += 1) {
+					DoubleDigitT result = (DoubleDigitT)t[j] + carry;
+					
+					t[j] = (DigitT)result;
+					carry = result >> DIGIT_BITS;
+				}
+			}
+			
+			// The result is less than 2m:
+			DigitT * r = t + n;
+			
+			if (r[n] != 0 || SignedDigits::compare(r, significant_digits(r, n), m, n) >= 0) {
+				subtract_digits(r, n + 1, m, n);
+			}
+		}
+		
+		MontgomeryReduction::MontgomeryReduction(const Integer & _mod) : mod(_mod) {
+			mod.normalize();
+			
+			assert(mod[0] & 1);
+			
+			n = mod.size();
+			
+			// Newton's iteration doubles the number of correct low bits each time, and x = m is correct to three bits as m * m = 1 mod 8 for odd m:
+			DigitT x = mod[0];
+			
+			for (std::size_t bits = 3; bits < DIGIT_BITS; bits *= 2) {
+				x *= 2 - mod[0] * x;
+			}
+			
+			inverse = -x;
+			
+			one = 1;
+			one.shift_left_digits(n);
+			one.modulus(mod);
+			
+			r2 = 1;
+			r2.shift_left_digits(2 * n);
+			r2.modulus(mod);
+		}
+		
+		void MontgomeryReduction::multiply(Integer & x, const Integer & a, const Integer & b) const {
+			Workspace workspace;
+			
+			multiply(x, a, b, workspace);
+		}
+		
+		void MontgomeryReduction::multiply(Integer & x, const Integer & a, const Integer & b, Workspace & workspace) const {
+			std::size_t na = std::max<std::size_t>(significant_digits(a.value().data(), a.size()), 1);
+			std::size_t nb = std::max<std::size_t>(significant_digits(b.value().data(), b.size()), 1);
+			
+			WorkspaceT t;
+			t.resize(2 * n + 1);
+			
+			// If a and b are the same integer, this squares it:
+			multiply_digits(t.data(), a.value().data(), na, b.value().data(), nb, workspace);
+			
+			reduce_montgomery(t.data(), mod.value().data(), n, inverse);
+			
+			Integer::ValueT & digits = x.value();
+			digits.clear();
+			digits.resize(n);
+			
+			std::copy(t.begin() + n, t.begin() + 2 * n, digits.begin());
+			
+			x.normalize();
+		}
+		
+		void MontgomeryReduction::to_montgomery(Integer & x) const {
+			multiply(x, x, r2);
+		}
+		
+		void MontgomeryReduction::from_montgomery(Integer & x) const {
+			std::size_t nx = std::max<std::size_t>(significant_digits(x.value().data(), x.size()), 1);
+			
+			WorkspaceT t;
+			t.resize(2 * n + 1);
+			std::copy(x.value().begin(), x.value().begin() + nx, t.begin());
+			
+			reduce_montgomery(t.data(), mod.value().data(), n, inverse);
+			
+			Integer::ValueT & digits = x.value();
+			digits.clear();
+			digits.resize(n);
+			
+			std::copy(t.begin() + n, t.begin() + 2 * n, digits.begin());
+			
+			x.normalize();
+		}
+		
+		// The width of the sliding window for an exponent with the given number of bits, which balances the 2^(k-1) products required to build the table against the products saved while scanning the exponent.
+		static std::size_t window_size(std::size_t bits) {
+			if (bits <= 8) return 1;
+			if (bits <= 24) return 2;
+			if (bits <= 80) return 3;
+			if (bits <= 240) return 4;
+			if (bits <= 672) return 5;
+			if (bits <= 1792) return 6;
+			
+			return 7;
+		}
+		
+		static bool test_bit(const Integer & value, std::size_t bit) {
+			return (value[bit / DIGIT_BITS] >> (bit % DIGIT_BITS)) & 1;
+		}
+		
+		/* Computes base^exponent by scanning the exponent from the most significant bit. Each window of up to k bits which starts and ends with a set bit is handled by squaring k times and multiplying by one of the precomputed odd powers of the base. MultiplyT(x, a, b) computes the modular product x = a * b, and one is the identity.
+		 */
+		template <typename MultiplyT>
+		static void sliding_window_power(Integer & result, const Integer & base, const Integer & exponent, const Integer & one, MultiplyT multiply) {
+			std::size_t digits = significant_digits(exponent.value().data(), exponent.size());
+			
+			if (digits == 0) {
+				result = one;
+				return;
+			}
+			
+			std::size_t bits = (digits - 1) * DIGIT_BITS + find_last_set(exponent[digits - 1]);
+			std::size_t k = window_size(bits);
+			
+			// The odd powers base^1, base^3, ..., base^(2^k - 1):
+			std::vector<Integer> powers(1 << (k - 1));
+			powers[0] = base;
+			
+			if (k > 1) {
+				Integer square;
+				multiply(square, base, base);
+				
+				for (std::size_t i = 1; i < powers.size(); i += 1) {
+					multiply(powers[i], powers[i-1], square);
+				}
+			}
+			
+			// Until the first window, the result is one, so there is no need to square it:
+			bool first = true;
+			std::size_t i = bits;
+			
+			while (i > 0) {
+				if (!test_bit(exponent, i - 1)) {
+					if (!first)
+						multiply(result, result, result);
+					
+					i -= 1;
+					continue;
+				}
+				
+				// Find the longest window ending in a set bit:
+				std::size_t low = i > k ? i - k : 0;
+				
+				while (!test_bit(exponent, low))
+					low += 1;
+				
+				std::size_t window = 0;
+				
+				for (std::size_t j = i; j > low; j -= 1) {
+					window = (window << 1) | test_bit(exponent, j - 1);
+					
+					if (!first)
+						multiply(result, result, result);
+				}
+				
+				if (first) {
+					result = powers[window >> 1];
+					first = false;
+				} else {
+					multiply(result, result, powers[window >> 1]);
+				}
+				
+				i = low;
+			}
+		}
+		
+		void Integer::set_power (Integer base, const Integer & exponent, const Integer & mod) {
+			if (mod[0] & 1) {
+				MontgomeryReduction r (mod);
+				set_power(base, exponent, r);
+			} else {
+				BarrettReduction r (mod);
+				set_power(base, exponent, r);
+			}
+		}
+		
+		void Integer::set_power (Integer base, const Integer & exponent, const BarrettReduction & r) {
+			// The reduction is only valid for products of values which are less than the modulus:
+			if (base >= r.mod)
+				base.modulus(r.mod);
+			
+			Workspace workspace;
+			
+			sliding_window_power(*this, base, exponent, 1, [&](Integer & x, const Integer & a, const Integer & b) {
+				x.set_product(a, b, workspace);
+				r.modulus(x);
+			});
+		}
+		
+		void Integer::set_power (Integer base, const Integer & exponent, const MontgomeryReduction & r) {
+			if (base >= r.mod)
+				base.modulus(r.mod);
+			
+			r.to_montgomery(base);
+			
+			Workspace workspace;
+			
+			sliding_window_power(*this, base, exponent, r.one, [&](Integer & x, const Integer & a, const Integer & b) {
+				r.multiply(x, a, b, workspace);
+			});
+			
+			r.from_montgomery(*this);
+		}
+		
+		void Integer::set_power (const Integer & base, const Integer & exponent) {
+			Workspace workspace;
 			
-			if (r2 > x) {
-				x.add(bkp);
+			set_power(base, exponent, workspace);
+		}
+		
+		void Integer::set_power (const Integer & base, const Integer & exponent, Workspace & workspace) {
+			const std::size_t nb = significant_digits(base._value.data(), base.size());
+			const std::size_t ne = significant_digits(exponent._value.data(), exponent.size());
+			
+			if (ne == 0 || (nb == 1 && base[0] == 1)) {
+				(*this) = 1;
+				return;
 			}
 			
-			x.subtract(r2);
+			if (nb == 0) {
+				(*this) = 0;
+				return;
+			}
 			
-			while (x >= mod) {
-				x.subtract(mod);
+			if (ne > INTERMEDIATE_DIGITS)
+				throw std::range_error("Exponent is too large!");
+			
+			const std::size_t base_bits = (nb - 1) * DIGIT_BITS + find_last_set(base[nb - 1]);
+			const IntermediateT power = exponent.to_intermediate();
+			
+			if (power > std::numeric_limits<std::size_t>::max() / base_bits)
+				throw std::range_error("Exponent is too large!");
+			
+			// Every intermediate power base^k is less than 2^(base_bits * k), where k is at most the exponent. A few more digits are required as the products are calculated with the full number of digits of each operand:
+			const std::size_t n = base_bits * power / DIGIT_BITS + 3;
+			
+			Workspace::Scope scope(workspace);
+			
+			DigitT * x = workspace.allocate(n), * y = workspace.allocate(n);
+			const DigitT * b = base._value.data();
+			
+			std::copy(b, b + nb, x);
+			std::size_t nx = nb;
+			
+			// Scan the exponent from the bit below the most significant one, which accounts for the initial value of x:
+			for (std::size_t i = (ne - 1) * DIGIT_BITS + find_last_set(exponent[ne - 1]) - 1; i > 0; i -= 1) {
+				square_digits(y, x, nx, workspace);
+				nx = significant_digits(y, 2 * nx);
+				std::swap(x, y);
+				
+				if (test_bit(exponent, i - 1)) {
+					multiply_digits(y, x, nx, b, nb, workspace);
+					nx = significant_digits(y, nx + nb);
+					std::swap(x, y);
+				}
 			}
 			
-			//x = r1;
-			x.normalize();
+			_value.resize(nx);
+			std::copy(x, x + nx, _value.begin());
 		}
 		
-		void Integer::set_square(const Integer & base)
-		{
-			this->set_product(base, base);
-		}
+// MARK: Square Root
 		
-		void Integer::set_power (Integer base, Integer exponent, const Integer & mod) {
-			BarrettReduction r (mod);
-			set_power(base, exponent, r);
+		void Integer::set_square_root(const Integer & value) {
+			Workspace workspace;
+			
+			set_square_root(value, workspace);
 		}
 		
-		void Integer::set_power (Integer base, Integer exponent, const BarrettReduction & r) {
-			(*this) = 1;
-			Integer tmp;
+		void Integer::set_square_root(const Integer & value, Workspace & workspace) {
+			Integer n = value;
+			n.normalize();
 			
-			while (exponent != 0) {
-				if (exponent._value[0] & 1) {
-					tmp.set_product(*this, base);
-					tmp._value.swap(this->_value);
-					
-					r.modulus(*this);
-				}
-				
-				exponent.shift_right(1);
+			if (n.is_zero()) {
+				(*this) = 0;
+				return;
+			}
+			
+			const std::size_t bits = n.bit_size();
+			Integer x;
+			
+			// Newton's iteration converges to the square root from any estimate which isn't smaller, and doubles the number of correct bits each time:
+			if (bits <= 4 * DIGIT_BITS) {
+				x = 1;
+				x.shift_left((bits + 1) / 2);
+			} else {
+				// If the top half of the value is t = n >> 2k, then sqrt(n) < (sqrt(t) + 1) << k, which is already correct to about k bits:
+				const std::size_t k = bits / 4;
 				
-				tmp.set_product(base, base);
-				tmp._value.swap(base._value);
+				Integer top = n;
+				top.shift_right(2 * k);
 				
-				r.modulus(base);
+				x.set_square_root(top, workspace);
+				x.add(1);
+				x.shift_left(k);
+				x.normalize();
 			}
-		}
-		
-		void Integer::set_power (Integer base, const Integer & exponent) {
-			DigitT mask = 1 << (DIGIT_BITS - 1);
-			std::size_t offset = exponent.size() - 1;
 			
-			Integer a, b = 1;
+			Integer quotient, remainder, next;
 			
-			while (1) {
-				DigitT current = exponent[offset];
+			while (true) {
+				quotient.set_fraction(n, x, remainder, workspace);
 				
-				for (std::size_t i = 0; i < DIGIT_BITS; ++i) {
-					a.set_square(b);
-					
-					if (current & mask) {
-						b.set_product(a, base);
-					} else {
-						b.swap(a);
-					}
-					
-					current <<= 1;
-				}
+				next = x;
+				next.add(quotient);
+				next.shift_right(1);
 				
-				if (offset == 0)
+				// The estimates decrease until they reach the square root:
+				if (next >= x)
 					break;
 				
-				offset -= 1;
+				x.swap(next);
 			}
 			
-			this->swap(b);
+			this->swap(x);
 		}
 		
+// MARK: -
+		
 		void Integer::shift_left(DigitT amount) {
 			DigitT steps = (amount / DIGIT_BITS);
 			DigitT bits = (amount % DIGIT_BITS);
@@ -773,7 +1865,7 @@ namespace Kai {
 			for (std::size_t i = (steps+1); i < _value.size(); i += 1) {
 				std::size_t j = _value.size() - (i+1);
 				
-				IntermediateT result = (IntermediateT)_value[j] << bits;
+				DoubleDigitT result = (DoubleDigitT)_value[j] << bits;
 				
 				_value[j+steps+1] |= (result >> DIGIT_BITS);
 				_value[j+steps] = result;
@@ -801,7 +1893,7 @@ namespace Kai {
 			}
 			
 			for (std::size_t i = steps; i < _value.size(); i += 1) {
-				IntermediateT result = (IntermediateT)_value[i] << (DIGIT_BITS - bits);
+				DoubleDigitT result = (DoubleDigitT)_value[i] << (DIGIT_BITS - bits);
 				
 				std::size_t s = i - steps;
 				if (s != 0)
@@ -862,19 +1954,21 @@ namespace Kai {
 		
 		// Returns a large random number. Digits is in multiple of 32 bits.
 		void Integer::generate_random_number (DigitT length) {
-			static std::ifstream * random_device = NULL;
+			// Each thread reads from its own stream, so that primes can be generated concurrently:
+			thread_local std::ifstream random_device("/dev/urandom", std::ios::binary);
 			
-			if (!random_device) {
-				random_device = new std::ifstream("/dev/urandom", std::ios::binary);
-			}
+			// The length is in multiples of 32 bits, so that it doesn't depend on the size of a digit:
+			std::size_t bytes = (std::size_t)length * 4;
+			
+			_value.clear();
+			_value.resize((bytes + sizeof(DigitT) - 1) / sizeof(DigitT));
 			
-			_value.resize(length);
-			random_device->read((char*)&_value[0], (std::size_t)_value.size() * sizeof(DigitT));
+			random_device.read((char*)_value.data(), bytes);
 		}
 		
 		// Returns a large random number between min and max.
 		void Integer::generate_random_number (Integer min, Integer max) {
-			generate_random_number(max.value().size());
+			generate_random_number(max.value().size() * (DIGIT_BITS / 32));
 			
 			Integer diff = max;
 			diff.subtract(min);
@@ -886,88 +1980,391 @@ namespace Kai {
 			assert(*this > min);
 		}
 		
-		// Returns the greatest common divisor of a and b.
-		void Integer::calculate_greatest_common_divisor (Integer a, Integer b) {
-			while (b != 0) {
-				Integer tmp = a;
-				tmp.modulus(b);
+// MARK: Greatest Common Divisor
+		
+		static DigitT greatest_common_divisor_digit(DigitT a, DigitT b) {
+			if (a == 0) return b;
+			if (b == 0) return a;
+			
+			// Binary GCD, which only needs shifts and subtractions:
+			unsigned shift = __builtin_ctzll(a | b);
+			a >>= __builtin_ctzll(a);
+			
+			do {
+				b >>= __builtin_ctzll(b);
+				
+				if (a > b) std::swap(a, b);
+				
+				b -= a;
+			} while (b != 0);
+			
+			return a << shift;
+		}
+		
+		/* The cofactors of several steps of Euclid's algorithm, which map (a, b) to (a', b'). The signs of the cofactors alternate with each step, so only their magnitudes are stored:
+		 
+		 a' = A * a - B * b, b' = D * b - C * a, after an even number of steps,
+		 a' = B * b - A * a, b' = C * a - D * b, after an odd number of steps.
+		 */
+		struct LehmerMatrix {
+			DigitT a, b, c, d;
+			bool odd;
+		};
+		
+		// Simulates Euclid's algorithm on the leading bits of a and b, using Knuth's algorithm L, and returns false if not even one step could be determined, in which case a full division is required. b must not have more digits than a, and a must have at least two digits.
+		static bool lehmer_matrix(const Integer & a, const Integer & b, LehmerMatrix & m) {
+			const std::size_t n = a.size();
+			const std::size_t shift = DIGIT_BITS - find_last_set(a[n-1]);
+			
+			auto leading = [&](const Integer & v) -> DigitT {
+				DigitT high = (n - 1 < v.size()) ? v[n-1] : 0;
+				DigitT low = (n - 2 < v.size()) ? v[n-2] : 0;
+				
+				return shift ? (high << shift) | (low >> (DIGIT_BITS - shift)) : high;
+			};
+			
+			DigitT x = leading(a), y = leading(b);
+			
+			m.a = 1;
+			m.b = 0;
+			m.c = 0;
+			m.d = 1;
+			m.odd = false;
+			
+			while (true) {
+				// The quotients of the bounds on the real values of a and b must agree:
+				DoubleDigitT q, r;
+				
+				if (!m.odd) {
+					if (y <= m.c || x < m.b) break;
+					
+					q = ((DoubleDigitT)x + m.a) / (y - m.c);
+					r = ((DoubleDigitT)x - m.b) / ((DoubleDigitT)y + m.d);
+				} else {
+					if (y <= m.d || x < m.a) break;
+					
+					q = ((DoubleDigitT)x - m.a) / ((DoubleDigitT)y + m.c);
+					r = ((DoubleDigitT)x + m.b) / (y - m.d);
+				}
+				
+				if (q != r) break;
+				
+				// The magnitudes of the cofactors accumulate, since their signs alternate:
+				DoubleDigitT c = m.a + q * m.c, d = m.b + q * m.d;
+				
+				if (c >= B || d >= B) break;
 				
-				a = b;
-				b = tmp;
+				m.a = m.c, m.b = m.d, m.c = c, m.d = d;
+				m.odd = !m.odd;
+				
+				DigitT t = x - q * y;
+				x = y, y = t;
 			}
 			
-			(*this) = a;
+			return m.b != 0;
 		}
 		
-		//	Computes inv = u^(-1) mod v */
-		//	Ref: Knuth Algorithm X Vol 2 p 342
-		//		ignoring u2, v2, t2
-		//		and avoiding negative numbers.
-		//		Returns non-zero if inverse undefined.
-		void Integer::calculate_inverse (Integer u, Integer v) {
-			Integer u1 = 1, u3 = u, v1 = 0, v3 = v;	
-			bool odd = false;
+		// Calculates p * x[i] - q * y[i] one digit at a time, for a result which is known to be non-negative.
+		struct DifferenceOfProducts {
+			DigitT p, q;
+			DoubleDigitT carry_p, carry_q, borrow;
 			
-			Integer q, t3, w, t1;
-			while (v3 != 0) {
-				// BigIntT q = u3 / v3, t3 = u3 % v3;
-				q.set_fraction(u3, v3, t3);
+			DifferenceOfProducts(DigitT _p, DigitT _q) : p(_p), q(_q), carry_p(0), carry_q(0), borrow(0) {}
+			
+			DigitT next(DigitT x, DigitT y) {
+				DoubleDigitT px = (DoubleDigitT)x * p + carry_p;
+				DoubleDigitT qy = (DoubleDigitT)y * q + carry_q;
+				
+				carry_p = px >> DIGIT_BITS;
+				carry_q = qy >> DIGIT_BITS;
 				
-				// BigIntT w = q * v1;
-				w.set_product(q, v1);
+				DoubleDigitT result = (DoubleDigitT)(DigitT)px - (DigitT)qy - borrow;
+				borrow = (result >> DIGIT_BITS) & 1;
 				
-				// BigIntT t1 = u1 + w;
-				t1 = u1;
-				t1.add(w);
+				return (DigitT)result;
+			}
+		};
+		
+		// Calculates p * x[i] + q * y[i] one digit at a time.
+		struct SumOfProducts {
+			DigitT p, q;
+			DoubleDigitT carry;
+			
+			SumOfProducts(DigitT _p, DigitT _q) : p(_p), q(_q), carry(0) {}
+			
+			DigitT next(DigitT x, DigitT y) {
+				DoubleDigitT px = (DoubleDigitT)x * p;
+				DoubleDigitT qy = (DoubleDigitT)y * q;
+				DoubleDigitT low = (DoubleDigitT)(DigitT)px + (DigitT)qy + (DigitT)carry;
 				
-				u1 = v1;
-				v1 = t1;
-				u3 = v3;
-				v3 = t3;
+				carry = (px >> DIGIT_BITS) + (qy >> DIGIT_BITS) + (carry >> DIGIT_BITS) + (low >> DIGIT_BITS);
 				
-				odd = !odd;
+				return (DigitT)low;
 			}
+		};
+		
+		// Applies the matrix to a and b in place, where b has no more digits than a.
+		static void apply_lehmer_matrix(Integer & a, Integer & b, const LehmerMatrix & m) {
+			const std::size_t n = a.size();
+			b.value().resize(n);
 			
-			if (odd) {
-				(*this) = v;
-				this->subtract(u1);
+			DigitT * x = a.value().data(), * y = b.value().data();
+			
+			if (!m.odd) {
+				DifferenceOfProducts u(m.a, m.b), v(m.d, m.c);
+				
+				for (std::size_t i = 0; i < n; i += 1) {
+					DigitT s = u.next(x[i], y[i]), t = v.next(y[i], x[i]);
+					x[i] = s, y[i] = t;
+				}
 			} else {
-				(*this) = u1;
+				DifferenceOfProducts u(m.b, m.a), v(m.c, m.d);
+				
+				for (std::size_t i = 0; i < n; i += 1) {
+					DigitT s = u.next(y[i], x[i]), t = v.next(x[i], y[i]);
+					x[i] = s, y[i] = t;
+				}
 			}
+			
+			a.normalize();
+			b.normalize();
 		}
 		
-		// This function implements simple jacobi test.
-		static int jacobi (Integer m, Integer n) {
-			int i = 1;
-			Integer t;
+		// The magnitudes of the cofactors of the original a in the current a and b. Their signs alternate with each step of Euclid's algorithm, so the cofactor of a is positive after an even number of steps.
+		struct Cofactors {
+			Integer a, b;
+			bool odd;
 			
-			while (m > 1) {
-				Integer j = 0;
+			Cofactors() : a(1), b(0), odd(false) {}
+			
+			void apply(const LehmerMatrix & m) {
+				const std::size_t n = std::max(a.size(), b.size()) + 2;
+				
+				a.value().resize(n);
+				b.value().resize(n);
 				
-				while ((m[0] & 1) == 0) {
-					j.add(1);
-					m.shift_right(1);
+				DigitT * x = a.value().data(), * y = b.value().data();
+				SumOfProducts u(m.a, m.b), v(m.c, m.d);
+				
+				for (std::size_t i = 0; i < n; i += 1) {
+					DigitT s = u.next(x[i], y[i]), t = v.next(x[i], y[i]);
+					x[i] = s, y[i] = t;
 				}
 				
-				if ((j[0] & 1) == 1) {
-					t = n[0] & 7;
+				a.normalize();
+				b.normalize();
+				
+				odd = odd != m.odd;
+			}
+			
+			void apply(const Integer & quotient) {
+				Integer t;
+				t.set_product(quotient, b);
+				t.add(a);
+				
+				a.swap(b);
+				b.swap(t);
+				
+				odd = !odd;
+			}
+		};
+		
+		// Reduces a and b using Lehmer's algorithm until b has a single digit, where a >= b. Each step of the simulation on the leading digits replaces a full division, and the cofactors are applied to a and b in a single pass.
+		static void reduce_lehmer(Integer & a, Integer & b, Cofactors * cofactors) {
+			LehmerMatrix m;
+			Integer q, r;
+			
+			while (b.size() > 1) {
+				if (lehmer_matrix(a, b, m)) {
+					apply_lehmer_matrix(a, b, m);
+					
+					if (cofactors) cofactors->apply(m);
+				} else {
+					q.set_fraction(a, b, r);
+					
+					a.swap(b);
+					b.swap(r);
 					
-					if ((t == 3) || (t == 5))
-						i = -i;
+					if (cofactors) cofactors->apply(q);
+				}
+			}
+		}
+		
+		void Integer::calculate_greatest_common_divisor (Integer a, Integer b) {
+			a.normalize();
+			b.normalize();
+			
+			if (a < b) a.swap(b);
+			
+			reduce_lehmer(a, b, NULL);
+			
+			// a mod b fits in a single digit, so the rest of the calculation can be done directly:
+			DigitT y = b[0], x = y ? divide_digit(a._value.data(), a.size(), y) : 0;
+			
+			if (y == 0)
+				this->swap(a);
+			else
+				(*this) = greatest_common_divisor_digit(y, x);
+		}
+		
+		void Integer::calculate_greatest_common_divisor (Integer a, Integer b, Integer & x, Integer & y) {
+			a.normalize();
+			b.normalize();
+			
+			if (a.is_zero()) {
+				throw std::domain_error("Bezout coefficients are undefined for a = 0!");
+			}
+			
+			Integer original_a = a, original_b = b;
+			
+			Cofactors cofactors;
+			
+			// The first step of Euclid's algorithm swaps a and b if a is smaller:
+			if (a < b) {
+				a.swap(b);
+				cofactors.apply(Integer(0));
+			}
+			
+			reduce_lehmer(a, b, &cofactors);
+			
+			Integer q, r;
+			
+			while (!b.is_zero()) {
+				q.set_fraction(a, b, r);
+				
+				a.swap(b);
+				b.swap(r);
+				
+				cofactors.apply(q);
+			}
+			
+			// original_a * x = a mod original_b, and x must be positive, so a negative cofactor is replaced by one which is congruent modulo original_b / a:
+			if (cofactors.odd) {
+				x.set_fraction(original_b, a, r);
+				x.subtract(cofactors.a);
+			} else {
+				x = cofactors.a;
+			}
+			
+			// original_a * x - a is a multiple of original_b:
+			if (original_b.is_zero()) {
+				y = 0;
+			} else {
+				Integer product;
+				product.set_product(original_a, x);
+				product.subtract(a);
+				
+				y.set_fraction(product, original_b, r);
+			}
+			
+			this->swap(a);
+		}
+		
+		void Integer::calculate_inverse (Integer u, Integer v) {
+			u.modulus(v);
+			
+			if (u.is_zero()) {
+				if (v == 1) {
+					(*this) = 0;
+					return;
 				}
 				
-				if ((m[0] & 3) == 3 && (n[0] & 3) == 3) {
-					i = -i;
+				throw std::domain_error("Inverse is undefined!");
+			}
+			
+			Integer x, y;
+			calculate_greatest_common_divisor(u, v, x, y);
+			
+			if (*this != 1) {
+				throw std::domain_error("Inverse is undefined!");
+			}
+			
+			x.modulus(v);
+			this->swap(x);
+		}
+		
+// MARK: Prime Numbers
+		
+		// Candidates are sieved by the odd primes below this bound before they are tested, which rejects roughly 85% of them.
+		static const uint32_t SIEVE_BOUND = 1 << 13;
+		
+		// The number of odd candidates following each random starting point which are sieved together.
+		static const std::size_t SIEVE_LENGTH = 1 << 12;
+		
+		static std::vector<uint32_t> odd_primes_below(uint32_t bound) {
+			std::vector<bool> composite(bound);
+			std::vector<uint32_t> primes;
+			
+			for (uint32_t i = 3; i < bound; i += 2) {
+				if (composite[i]) continue;
+				
+				primes.push_back(i);
+				
+				for (uint32_t j = i * i; j < bound; j += 2 * i)
+					composite[j] = true;
+			}
+			
+			return primes;
+		}
+		
+		static const std::vector<uint32_t> & small_primes() {
+			static const std::vector<uint32_t> primes = odd_primes_below(SIEVE_BOUND);
+			
+			return primes;
+		}
+		
+		// Returns x mod q for q < 2^16, in 32 bit steps so that every division fits in a machine word.
+		static uint32_t remainder_small(const Integer & x, uint32_t q) {
+			uint64_t remainder = 0;
+			
+			for (std::size_t i = x.size(); i > 0; i -= 1) {
+				for (std::size_t shift = DIGIT_BITS; shift > 0; shift -= 32) {
+					remainder = ((remainder << 32) | (uint32_t)(x[i-1] >> (shift - 32))) % q;
 				}
+			}
+			
+			return remainder;
+		}
+		
+		// The Miller-Rabin test, where p is odd and larger than any of the small primes. The first witness is two, which rejects almost every composite which gets through the sieve, and the rest are random.
+		static bool miller_rabin(const Integer & p, int tests) {
+			Integer p1 = p;
+			p1.subtract(1);
+			
+			// p - 1 = d * 2^s, where d is odd:
+			std::size_t s = 0;
+			while (!test_bit(p1, s)) s += 1;
+			
+			Integer d = p1;
+			d.shift_right(s);
+			
+			// Cache the reduction for better set_power, and compare in Montgomery form, so that the squarings don't need to be converted:
+			MontgomeryReduction reduction (p);
+			
+			Integer minus_one = p1;
+			reduction.to_montgomery(minus_one);
+			
+			Integer a = 2, x;
+			
+			for (int i = 0; i < tests; i += 1) {
+				if (i > 0) a.generate_random_number(2, p1);
+				
+				x.set_power(a, d, reduction);
+				reduction.to_montgomery(x);
 				
-				t = n;
+				if (x == reduction.one || x == minus_one) continue;
+				
+				for (std::size_t j = 1; j < s; j += 1) {
+					reduction.multiply(x, x, x);
+					
+					if (x == minus_one || x == reduction.one) break;
+				}
 				
-				t.modulus(m);
-				n = m;
-				m = t;
+				// p is composite
+				if (x != minus_one) return false;
 			}
 			
-			return i;
+			return true;
 		}
 		
 		bool Integer::is_probably_prime (int tests) const {
@@ -977,65 +2374,123 @@ namespace Kai {
 				return true;
 			}
 			
-			// Cache the reduction for better set_power.
-			BarrettReduction br (p);
+			// Even numbers other than two are composite, and Montgomery reduction requires an odd modulus:
+			if (p < 2 || (p[0] & 1) == 0) {
+				return false;
+			}
+			
+			for (uint32_t q : small_primes()) {
+				if (remainder_small(p, q) == 0)
+					return p == q;
+			}
+			
+			// All composites below the square of the sieve bound have a small factor:
+			if (p < (IntermediateT)SIEVE_BOUND * SIEVE_BOUND) {
+				return true;
+			}
+			
+			return miller_rabin(p, tests);
+		}
+		
+		/* Each thread searches for a prime among the odd numbers following random starting points, until one of them finds one. Each range of candidates is sieved by the small primes first, so only the survivors are tested, which is roughly seven times faster than testing every odd number.
+		 */
+		struct PrimeSearch {
+			std::atomic<bool> found;
+			std::mutex lock;
+			Integer prime;
+			
+			PrimeSearch() : found(false) {}
 			
-			while (tests-- > 0) {
-				Integer a = 0;
-				a.generate_random_number(2, p);
+			// Tests the odd numbers start + 2k, for k < SIEVE_LENGTH, which are less than max if it is given, and returns true if any of them was prime.
+			bool search(const Integer & start, const Integer * max) {
+				std::vector<bool> composite(SIEVE_LENGTH);
+				
+				for (uint32_t q : small_primes()) {
+					// start + 2k = 0 mod q when k = (q - r) / 2 mod q:
+					uint32_t r = remainder_small(start, q);
+					std::size_t k = r ? (r & 1 ? q - r : 2 * q - r) / 2 : 0;
+					
+					// Don't sieve out the small prime itself:
+					if (start < SIEVE_BOUND && start[0] + 2 * k == q)
+						k += q;
+					
+					for (; k < SIEVE_LENGTH; k += q)
+						composite[k] = true;
+				}
 				
-				Integer gcd = 0;
-				gcd.calculate_greatest_common_divisor(a, p);
+				Integer candidate;
 				
-				if (gcd == 1) {
-					Integer l = 0, e = 0, p1 = p;
-					p1.subtract(1);
-					e = p1;
-					e.shift_right(1);
+				for (std::size_t k = 0; k < SIEVE_LENGTH && !found; k += 1) {
+					if (composite[k]) continue;
+					
+					candidate = start;
+					candidate.add(Integer(2 * k));
 					
-					l.set_power(a, e, br);
+					if (max && candidate >= *max) break;
 					
-					int j = jacobi(a, p);
+					// Sieved candidates don't need trial division, unless they could be one of the small primes:
+					bool probably_prime = candidate < (IntermediateT)SIEVE_BOUND * SIEVE_BOUND ? candidate.is_probably_prime() : miller_rabin(candidate, 10);
 					
-					if (((j == -1) && (l == p1)) || ((j == 1) && (l == 1))) {
-						// So far so good...
-					} else {
-						// p is composite
-						return false;
+					if (probably_prime) {
+						std::lock_guard<std::mutex> guard(lock);
+						
+						if (!found) {
+							prime = candidate;
+							found = true;
+						}
+						
+						return true;
 					}
-				} else {
-					// p is composite
-					return false;
 				}
+				
+				return false;
 			}
 			
-			return true;
-		}
-		
-		void Integer::generate_prime (DigitT length) {
-			while (true) {
-				//std::cout << "." << std::flush;
-				this->generate_random_number(length);
-				this->_value[0] |= 1; // Ensure odd number
+			// Runs the search on every available core. generate(start) chooses a random odd starting point.
+			template <typename GenerateT>
+			void run(GenerateT generate, const Integer * max) {
+				auto worker = [&]() {
+					Integer start;
+					
+					while (!found) {
+						generate(start);
+						
+						if (search(start, max)) return;
+					}
+				};
 				
-				if (is_probably_prime()) {
-					//std::cout << std::endl;
-					return;
-				}
+				std::vector<std::thread> threads(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+				
+				for (auto & thread : threads)
+					thread = std::thread(worker);
+				
+				worker();
+				
+				for (auto & thread : threads)
+					thread.join();
 			}
+		};
+		
+		void Integer::generate_prime (DigitT length) {
+			PrimeSearch search;
+			
+			search.run([&](Integer & start) {
+				start.generate_random_number(length);
+				start[0] |= 1; // Ensure odd number
+			}, NULL);
+			
+			this->swap(search.prime);
 		}
 		
 		void Integer::generate_prime (Integer min, Integer max) {
-			while (true) {
-				//std::cout << "." << std::flush;
-				this->generate_random_number(min, max);
-				this->_value[0] |= 1; // Ensure odd number
-				
-				if (is_probably_prime()) {
-					//std::cout << std::endl;
-					return;
-				}
-			}
+			PrimeSearch search;
+			
+			search.run([&](Integer & start) {
+				start.generate_random_number(min, max);
+				start[0] |= 1; // Ensure odd number
+			}, &max);
+			
+			this->swap(search.prime);
 		}
 		
 		bool Integer::find_prime_less_than (Integer max) {
@@ -1051,17 +2506,27 @@ namespace Kai {
 			return false;
 		}
 		
+		static uint32_t hexadecimal_group(const Integer::ValueT & value, std::size_t index) {
+			return (uint32_t)(value[index * 32 / DIGIT_BITS] >> (index * 32 % DIGIT_BITS));
+		}
+		
 		std::string Integer::to_hexadecimal(bool prefix) const {
 			std::stringstream buffer;
 			
 			if (prefix)
 				buffer << "0x";
 			
-			for (std::size_t i = 0; i < _value.size(); i += 1) {
-				DigitT d = _value[_value.size() - (i+1)];
+			// Digits are printed in groups of 32 bits, regardless of the size of a digit, so that the output is the same in every configuration. Leading groups of zeros are omitted:
+			std::size_t groups = _value.size() * (DIGIT_BITS / 32);
+			
+			while (groups > 1 && hexadecimal_group(_value, groups - 1) == 0)
+				groups -= 1;
+			
+			for (std::size_t i = groups; i > 0; i -= 1) {
+				uint32_t group = hexadecimal_group(_value, i - 1);
 				
-				for (unsigned n = 0; n < DIGIT_BITS; n += 4) {
-					buffer << convert_to_character((d >> (DIGIT_BITS - (n+4))) & 0xF);
+				for (unsigned n = 0; n < 32; n += 4) {
+					buffer << convert_to_character((group >> (28 - n)) & 0xF);
 				}
 			}
 			
@@ -1070,43 +2535,24 @@ namespace Kai {
 		
 		std::string Integer::to_string(BaseT base, bool prefix) const
 		{
-			std::size_t length = maximum_length_of_conversion(2, size() * DIGIT_BITS, base);
+			RadixPowers powers(base);
 			
-			// This will leak if there is an exception... =)1
-			char * buffer = (char *)alloca(length + 1);
-			char * end = buffer + length;
+			Integer copy = *this;
+			copy.normalize();
 			
-			buffer[length] = '\0';
+			// Find the smallest power which is bigger than the number:
+			std::size_t level = 0;
 			
-			// Calculate how many digits we can extract to a single precision with one division..
-			DigitT width;
-			Integer divisor = single_precision_base(base, width);
-			Integer copy = *this;
+			while (powers[level] <= copy)
+				level += 1;
 			
-			std::size_t i = 1, filled = 0;
-			while (1) {
-				Integer result, remainder;
-				
-				result.set_fraction(copy, divisor, remainder);
-				
-				char * next = end - width;
-				filled = single_precision_to_buffer(remainder.to_intermediate(), base, width, next);
-				
-				if (!result.is_zero()) {
-					// There is still more of the number to come, make sure that any remaining space in the buffer is zero-filled.
-					while (filled < width) {
-						filled += 1;
-						next[width - filled] = '0';
-					}
-				} else {
-					// Finished, create a string from the buffer:
-					return std::string(end - filled, buffer + length);
-				}
-				
-				result.swap(copy);
-				end = next;
-				i += 1;
-			}	
+			std::string buffer;
+			print_digits(copy, powers, level, 0, buffer);
+			
+			if (buffer.empty())
+				buffer.push_back('0');
+			
+			return buffer;
 		}
 		
 		DigitT Integer::to_digit() const {
@@ -1119,17 +2565,19 @@ namespace Kai {
 			}
 		}
 		
-		// This contains at least two digits.
+		// This contains at least one digit.
 		IntermediateT Integer::to_intermediate() const {
-			if (_value.size() == 0) {
-				return 0;
-			} else if (_value.size() == 1) {
-				return _value[0];
-			} else if (_value.size() == 2) {
-				return ((IntermediateT)_value[1] << DIGIT_BITS) | _value[0];
-			} else {
+			if (_value.size() > INTERMEDIATE_DIGITS) {
 				throw std::domain_error("overflow converting integer to intermediate");
 			}
+			
+			IntermediateT result = 0;
+			
+			for (std::size_t i = 0; i < _value.size(); i += 1) {
+				result |= (IntermediateT)_value[i] << (i * DIGIT_BITS);
+			}
+			
+			return result;
 		}
 		
 		std::size_t Integer::to_size() const {
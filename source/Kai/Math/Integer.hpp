@@ -14,6 +14,8 @@
 #include <stdint.h>
 #include <iostream>
 
+#include "InlineVector.hpp"
+
 namespace Kai {
 	namespace Math {
 		// Prints out a std::vector of values for debugging.
@@ -38,34 +40,141 @@ namespace Kai {
 		}
 		
 		struct BarrettReduction;
+		struct MontgomeryReduction;
 		
+		/* Digits are 64 bits wide where the compiler provides 128 bit arithmetic, so each step of every kernel handles as many bits as a single multiply or add-with-carry instruction can. This halves the number of digits, and roughly doubles the throughput of addition, multiplication and division. Define KAI_MATH_NARROW_DIGITS to use 32 bit digits instead.
+		 
+		 The width of a digit is not part of the public interface: IntermediateT is always 64 bits, so values which fit in a machine word can be converted in either configuration.
+		 */
+#if defined(__SIZEOF_INT128__) && !defined(KAI_MATH_NARROW_DIGITS)
 		// Used for individual digits in the big integer.
+		typedef uint64_t DigitT;
+		// Used for the results of operations on digits, must be twice as big as DigitT.
+		typedef unsigned __int128 DoubleDigitT;
+#else
 		typedef uint32_t DigitT;
-		// Used for containing intermediate values, must be at least twice as big as DigitT.
+		typedef uint64_t DoubleDigitT;
+#endif
+		
+		// Used for converting to and from machine words, must be at least as big as DigitT.
 		typedef uint64_t IntermediateT;
 		
 		// Used for representing the width of fractional parts.
-		typedef DigitT ScaleT;
-		typedef DigitT BaseT;
+		typedef uint32_t ScaleT;
+		typedef uint32_t BaseT;
 		
 		// Constants used for manipulating bits.
 		static const std::size_t DIGIT_BITS = sizeof(DigitT) * 8;
 		static const std::size_t INTERMEDIATE_BITS = sizeof(IntermediateT) * 8;
-		static const IntermediateT B = (IntermediateT)1 << DIGIT_BITS;		
+		static const DoubleDigitT B = (DoubleDigitT)1 << DIGIT_BITS;
+		
+		// The number of digits in a machine word, i.e. the largest integer which to_intermediate can convert.
+		static const std::size_t INTERMEDIATE_DIGITS = sizeof(IntermediateT) / sizeof(DigitT);
 		
 		// Character conversion helpers
 		char convert_to_character(DigitT);
 		DigitT convert_to_digit(char);
 		const char * prefix_for_base(BaseT base);
 		
+		/** Scratch memory for the temporary digits used by multiplication, division and exponentiation. Digits are taken from the workspace like a stack, and are given back when the enclosing scope ends. The workspace keeps its memory until it is destroyed, so once it has grown large enough, arithmetic using it doesn't allocate any temporaries.
+		 
+		 A workspace must only be used by one thread at a time. A copy of a workspace starts out empty.
+		 */
+		class Workspace {
+		public:
+			Workspace();
+			Workspace(const Workspace &);
+			
+			Workspace & operator=(const Workspace &) { return *this; }
+			
+			// Returns n uninitialized digits, which are valid until the enclosing scope ends.
+			DigitT * allocate(std::size_t n);
+			
+			// The number of digits held by the workspace.
+			std::size_t capacity() const;
+			
+			// Gives back the digits allocated from the workspace while the scope existed, when it is destroyed.
+			class Scope {
+			public:
+				Scope(Workspace & workspace);
+				~Scope();
+				
+			protected:
+				Workspace & _workspace;
+				std::size_t _block, _used;
+			};
+			
+		protected:
+			struct Block {
+				std::vector<DigitT> digits;
+				std::size_t used;
+			};
+			
+			// Blocks after the current one are empty.
+			std::vector<Block> _blocks;
+			std::size_t _current;
+		};
+		
 		class Integer {
 		public:
+			// Integers up to 128 bits are stored inline, without allocating any memory.
+			enum { INLINE_DIGITS = 128 / DIGIT_BITS };
+			
 			// The data type used to store numbers.
-			typedef std::vector<DigitT> ValueT;
+			typedef InlineVector<DigitT, INLINE_DIGITS> ValueT;
+			
+			/* The number of digits at which multiplication switches from the schoolbook method to Karatsuba, and then to Toom-3. These were measured on an x86-64 build machine (GCC, -O2) by timing each method at the top level of a product of two n-digit operands. Using 32 bit digits:
+			 
+			 digits    schoolbook    karatsuba    |    digits    karatsuba    toom-3
+			 32        1.43us        1.50us       |    160       21.6us       24.1us
+			 40        2.22us        2.15us       |    192       30.4us       29.5us
+			 48        3.23us        2.81us       |    256       49.4us       45.1us
+			 64        6.01us        4.95us       |    384       99.3us       82.8us
+			 
+			 Squaring is cheaper, so Karatsuba only pays off for larger operands, at around 48 digits, and Toom-3 at around 160-256 digits. For 4096 digit operands, a product takes 23.3ms using the schoolbook method, 4.3ms using Karatsuba, and 3.3ms using Toom-3, and a square takes 11.8ms using the schoolbook method and 1.8ms using Toom-3.
+			 
+			 Using 64 bit digits, each step of the schoolbook method does four times as much work, so the crossovers are at a similar number of digits:
+			 
+			 digits    schoolbook    karatsuba    |    digits    karatsuba    toom-3
+			 40        1.93us        2.14us       |    192       47.6us       47.5us
+			 48        2.64us        2.34us       |    256       77.7us       79.3us
+			 64        4.57us        4.01us       |    320       115us        105us
+			 80        7.28us        6.03us       |    384       149us        136us
+			 
+			 Toom-3 pays off at around 320 digits for both products and squares, and Karatsuba at around 64 digits for squares.
+			 */
+			enum {
+				KARATSUBA_THRESHOLD = DIGIT_BITS == 64 ? 48 : 40,
+				TOOM3_THRESHOLD = DIGIT_BITS == 64 ? 320 : 256,
+				KARATSUBA_SQUARE_THRESHOLD = DIGIT_BITS == 64 ? 64 : 48,
+				TOOM3_SQUARE_THRESHOLD = DIGIT_BITS == 64 ? 320 : 256
+			};
+			
+			// Numbers with more digits than this are converted to and from strings by splitting them in half using powers of the base, rather than one chunk of characters at a time, which is quadratic. Thresholds between 32 and 128 digits performed within a few percent of each other.
+			enum {
+				RADIX_CONVERSION_THRESHOLD = 64
+			};
+			
+			/* Divisors with at least this many digits are divided recursively using the method of Burnikel and Ziegler, which splits each division into two divisions of half the size and a product, so that it benefits from the fast multiplication. Divisions with a small quotient still use long division, which is linear in the size of the quotient. Dividing a 2n digit number by an n digit number, using 64 bit digits:
+			 
+			 digits    long division    recursive
+			 512       887us            842us
+			 1024      3.41ms           2.48ms
+			 2048      12.9ms           6.29ms
+			 8192      201ms            44.4ms
+			 
+			 Thresholds of 128 and 512 digits were slower than 256 digits for both 32 and 64 bit digits.
+			 */
+			enum {
+				BURNIKEL_ZIEGLER_THRESHOLD = 256
+			};
 			
 			// Maximise k in base^k such that it fits in a single-precision (IntermediateT) value; returns base^k.
 			static IntermediateT single_precision_base(BaseT base, DigitT & k);
 			
+			// Maximise k in base^k such that it fits in a single digit; returns base^k.
+			static DigitT single_digit_base(BaseT base, DigitT & k);
+			
 			// Given a number of digits in a given base, what is the maximum number of digits in a given output base.
 			static DigitT maximum_length_of_conversion(BaseT in_base, DigitT in_length, BaseT out_base);
 			
@@ -119,36 +228,51 @@ namespace Kai {
 			void add(const Integer & a);
 			
 			// a must be smaller than this.
-			// a cannot be aliased for this - it doesn't make sense anyway :)
+			// a can be aliased for this, in which case the result is zero.
 			void subtract(const Integer & a);
 			
 			// Convenience function
 			void multiply(const Integer & other);
+			void multiply(const Integer & other, Workspace & workspace);
 			
 			// Convenience function
 			void modulus(const Integer & m);
 			
-			// Cannot be aliased
+			// a and b can be aliased for this. If a and b are the same integer, it is squared.
 			void set_product(const Integer & a, const Integer & b);
 			
-			// Returns false if the division had a remainder.
+			// The temporary digits, including a copy of an operand which is aliased for this, are taken from the workspace.
+			void set_product(const Integer & a, const Integer & b, Workspace & workspace);
+			
+			// Adds the digits of every operand in a single pass, and then propagates the carries. Any of the operands can be aliased for this.
+			void set_sum(const Integer * const * operands, std::size_t count, Workspace & workspace);
+			
+			// Multiplies the operands using a product tree, which splits them into two halves with a similar number of digits, so that the larger products have balanced operands. Any of the operands can be aliased for this.
+			void set_product(const Integer * const * operands, std::size_t count, Workspace & workspace);
+			
+			// Divides using set_fraction, and returns false if the division had a remainder.
 			bool set_fraction_slow(const Integer & numerator, const Integer & denominator, Integer & remainder);
 			
-			// Slightly faster implementation, calculates x = qy + r, saves q in this, r in x
+			// Calculates numerator = q * denominator + r, saves q in this and r in remainder. Throws std::runtime_error if the denominator is zero. The numerator and denominator can be aliased for this or the remainder.
 			void set_fraction(const Integer & numerator, const Integer & denominator, Integer & remainder);
+			void set_fraction(const Integer & numerator, const Integer & denominator, Integer & remainder, Workspace & workspace);
 			
 			Integer fractional_part(ScaleT scale, const Integer & base = 10);
 			
-		protected:
-			void set_fraction(Integer & x, Integer y);
-			void set_square(const Integer & base);
+			// The intermediate powers are calculated in the workspace, so only the result is stored in this. Throws std::range_error if the result would be too large to represent.
+			void set_power(const Integer & base, const Integer & exponent);
+			void set_power(const Integer & base, const Integer & exponent, Workspace & workspace);
 			
-		public:
-			void set_power(Integer base, const Integer & exponent);
+			// Calculates the largest integer whose square is at most the value, using Newton's iteration from the square root of the most significant half of the value, which is calculated recursively. The value can be aliased for this.
+			void set_square_root(const Integer & value);
+			void set_square_root(const Integer & value, Workspace & workspace);
+			
+			// Uses Montgomery reduction if the modulus is odd, and Barrett reduction otherwise.
+			void set_power(Integer base, const Integer & exponent, const Integer & mod);
 			
-			// Uses Barrett Reduction
-			void set_power(Integer base, Integer exponent, const Integer & mod);
-			void set_power(Integer base, Integer exponent, const BarrettReduction & r);
+			// The exponent is scanned from the most significant bit using a sliding window, so only one modular product is required for each window of set bits.
+			void set_power(Integer base, const Integer & exponent, const BarrettReduction & r);
+			void set_power(Integer base, const Integer & exponent, const MontgomeryReduction & r);
 			
 			// Shift left makes a number bigger.
 			void shift_left(DigitT amount);
@@ -169,19 +293,22 @@ namespace Kai {
 			// Returns a large random number between min and max.
 			void generate_random_number(Integer min, Integer max);
 			
-			// Returns the greatest common divisor of a and b.
+			// Returns the greatest common divisor of a and b, using Lehmer's algorithm.
 			void calculate_greatest_common_divisor(Integer a, Integer b);
 			
-			//	Computes inv = u^(-1) mod v
+			// Also calculates the Bezout coefficients, such that a * x - b * y = gcd(a, b), where 0 < x <= b / gcd(a, b). a must not be zero.
+			void calculate_greatest_common_divisor(Integer a, Integer b, Integer & x, Integer & y);
+			
+			// Computes inv = u^(-1) mod v, and throws std::domain_error if u and v are not coprime.
 			void calculate_inverse(Integer u, Integer v);
 			
-			// Generates a prime number
+			// Generates a prime number between min and max, searching on every available core.
 			void generate_prime(Integer min, Integer max);
 			
 			// Generates a prime number - length is in multiple of 32 bits.
 			void generate_prime(DigitT length);
 			
-			// Use probabilistic methods to check for prime number
+			// Trial division by small primes, followed by the Miller-Rabin test with the given number of witnesses.
 			bool is_probably_prime(int tests = 10) const;
 			
 			// Finds a prime less than the given max, or returns false.
@@ -238,6 +365,30 @@ namespace Kai {
 			void modulus(Integer & x) const;
 		};
 		
+		/* Montgomery reduction represents x modulo an odd modulus m as x * R mod m, where R = B^n and m has n digits. The product of two such values is reduced by adding a multiple of m which makes the low n digits zero and then dropping them, which is cheaper than a division or a Barrett reduction.
+		 */
+		struct MontgomeryReduction {
+			// The modulus we are calculating, which must be odd.
+			Integer mod;
+			
+			// The number of digits in the modulus, and -mod^-1 mod B.
+			std::size_t n;
+			DigitT inverse;
+			
+			// R^2 mod m, used to convert into Montgomery form, and R mod m, the Montgomery form of one.
+			Integer r2, one;
+			
+			MontgomeryReduction(const Integer & _mod);
+			
+			// x = a * b * R^-1 mod m, where a and b are less than m. x can be aliased with a or b.
+			void multiply(Integer & x, const Integer & a, const Integer & b) const;
+			void multiply(Integer & x, const Integer & a, const Integer & b, Workspace & workspace) const;
+			
+			// Converts x, which must be less than m, to and from Montgomery form.
+			void to_montgomery(Integer & x) const;
+			void from_montgomery(Integer & x) const;
+		};
+		
 		
 		std::ostream & operator<<(std::ostream &, const Integer &);
 	}
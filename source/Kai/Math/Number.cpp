@@ -8,6 +8,7 @@
 
 #include "Number.hpp"
 #include <sstream>
+#include <stdexcept>
 
 namespace Kai {
 	namespace Math {
@@ -19,6 +20,47 @@ namespace Kai {
 			}
 		}
 		
+		static Integer power_of_ten(std::size_t exponent) {
+			Integer result;
+			result.set_power(10, exponent);
+			
+			return result;
+		}
+		
+		// Returns true if the truncated magnitude q should be rounded away from zero. The discarded fraction of q was remainder / divisor, and sticky is true if an even smaller non-zero fraction was discarded before that.
+		static bool round_away(const Integer & q, const Integer & remainder, const Integer & divisor, bool sticky, bool negative, Number::Rounding rounding) {
+			if (remainder.is_zero() && !sticky)
+				return false;
+			
+			// Compare the discarded fraction with one half:
+			Integer twice = remainder;
+			twice.add(remainder);
+			
+			int half = twice.compare_with(divisor);
+			
+			if (half == 0 && sticky)
+				half = 1;
+			
+			switch (rounding) {
+				case Number::FLOOR:
+					return negative;
+				case Number::CEILING:
+					return !negative;
+				case Number::DOWN:
+					return false;
+				case Number::UP:
+					return true;
+				case Number::HALF_UP:
+					return half >= 0;
+				case Number::HALF_DOWN:
+					return half > 0;
+				case Number::HALF_EVEN:
+					return half > 0 || (half == 0 && (q[0] & 1));
+			}
+			
+			return false;
+		}
+		
 		Number::Number(IntermediateT value) : _scale(0)
 		{
 			if (value < 0) {
@@ -54,11 +96,19 @@ namespace Kai {
 			
 			// Update the value based on the whole integer number (base-10).
 			_value = Integer(buffer.str(), 10);
+			
+			normalize();
 		}
 		
 		Number::Number(Integer value, unsigned scale, bool negative) : _negative(negative), _value(value), _scale(scale)
 		{
-			
+			_value.normalize();
+			normalize();
+		}
+		
+		void Number::normalize() {
+			if (_value.is_zero())
+				_negative = false;
 		}
 		
 		int Number::compare_with(const Number & other) const
@@ -71,15 +121,27 @@ namespace Kai {
 				return Integer::GREATER;
 			}
 			
-			// We need to normalize the integers based on the scale factor.
+			// Compare the magnitudes at the same scale:
+			Integer lhs = _value, rhs = other._value;
+			
+			if (_scale < other._scale)
+				lhs.multiply(power_of_ten(other._scale - _scale));
+			else if (_scale > other._scale)
+				rhs.multiply(power_of_ten(_scale - other._scale));
 			
-			// Broken =)
-			return Integer::EQUAL;
+			int result = lhs.compare_with(rhs);
+			
+			return _negative ? -result : result;
 		}
 		
 		Integer Number::fractional_part(const Integer & base) {
 			if (_scale) {
-				return _value.fractional_part(_scale, base);
+				Integer divisor, whole, fraction;
+				
+				divisor.set_power(base, _scale);
+				whole.set_fraction(_value, divisor, fraction);
+				
+				return fraction;
 			} else {
 				return 0;
 			}
@@ -87,50 +149,150 @@ namespace Kai {
 		
 		Integer Number::whole_part(const Integer & base) {
 			if (_scale) {
-				Integer copy = _value;
+				Integer divisor, whole, fraction;
 				
-				copy.subtract(fractional_part(base));
+				divisor.set_power(base, _scale);
+				whole.set_fraction(_value, divisor, fraction);
 				
-				return copy;
+				return whole;
 			} else {
 				return _value;
 			}
 		}
 		
+		void Number::rescale(ScaleT scale, Rounding rounding) {
+			if (scale >= _scale) {
+				_value.multiply(power_of_ten(scale - _scale));
+			} else {
+				Integer divisor = power_of_ten(_scale - scale), quotient, remainder;
+				quotient.set_fraction(_value, divisor, remainder);
+				
+				if (round_away(quotient, remainder, divisor, false, _negative, rounding))
+					quotient.add(1);
+				
+				_value.swap(quotient);
+			}
+			
+			_scale = scale;
+			normalize();
+		}
+		
 		void Number::multiply(const Number & other)
 		{
-			_negative = is_negative(_negative, other._negative);
+			_negative = Math::is_negative(_negative, other._negative);
 			_value.multiply(other._value);
 			_scale += other._scale;
+			
+			normalize();
 		}
-
+		
 		void Number::add(const Number & other) {
-			if (!_negative) {
-				if (other._negative) {
-					if (_value > other._value) {
-						_value.subtract(other._value);
-					} else {
-						
-					}
-				}
+			Integer value = other._value;
+			
+			// Add the magnitudes at the same scale:
+			if (_scale < other._scale) {
+				_value.multiply(power_of_ten(other._scale - _scale));
+				_scale = other._scale;
+			} else if (_scale > other._scale) {
+				value.multiply(power_of_ten(_scale - other._scale));
 			}
+			
+			if (_negative == other._negative) {
+				_value.add(value);
+			} else if (_value >= value) {
+				_value.subtract(value);
+			} else {
+				value.subtract(_value);
+				
+				_value.swap(value);
+				_negative = other._negative;
+			}
+			
+			_value.normalize();
+			normalize();
+		}
+		
+		void Number::subtract(const Number & other) {
+			Number negated = other;
+			negated._negative = !negated._negative;
+			
+			add(negated);
+		}
+		
+		void Number::divide(const Number & other, ScaleT scale, Rounding rounding) {
+			// (a / 10^sa) / (b / 10^sb) = (a * 10^(sb + scale)) / (b * 10^sa) / 10^scale:
+			Integer numerator = _value, denominator = other._value;
+			
+			numerator.multiply(power_of_ten(other._scale + scale));
+			denominator.multiply(power_of_ten(_scale));
+			
+			Integer quotient, remainder;
+			quotient.set_fraction(numerator, denominator, remainder);
+			
+			bool negative = Math::is_negative(_negative, other._negative);
+			
+			if (round_away(quotient, remainder, denominator, false, negative, rounding))
+				quotient.add(1);
+			
+			_value.swap(quotient);
+			_scale = scale;
+			_negative = negative;
+			
+			normalize();
+		}
+		
+		void Number::square_root(ScaleT scale, Rounding rounding) {
+			if (_negative) {
+				throw std::domain_error("Square root of a negative number!");
+			}
+			
+			// sqrt(a / 10^sa) = sqrt(a * 10^(2 * (scale + extra) - sa)) / 10^(scale + extra), where the extra digits make the exponent positive, and at least one is used for rounding:
+			std::size_t extra = 1;
+			
+			if (2 * ((std::size_t)scale + extra) < _scale)
+				extra = (_scale - 2 * (std::size_t)scale + 1) / 2;
+			
+			Integer value = _value;
+			value.multiply(power_of_ten(2 * (scale + extra) - _scale));
+			
+			Integer root, square;
+			root.set_square_root(value);
+			
+			// The digits below the extra ones are only known to be non-zero:
+			square.set_product(root, root);
+			bool sticky = square != value;
+			
+			Integer divisor = power_of_ten(extra), quotient, remainder;
+			quotient.set_fraction(root, divisor, remainder);
+			
+			if (round_away(quotient, remainder, divisor, sticky, false, rounding))
+				quotient.add(1);
+			
+			_value.swap(quotient);
+			_scale = scale;
+			
+			normalize();
 		}
 		
 		Number Number::floor() {
-			std::cerr << "Unimplemented: " << __func__ << std::endl;
-			// floor(n) = n - frac(n)
-			return 0;
+			Number result = *this;
+			result.rescale(0, FLOOR);
+			
+			return result;
 		}
 		
 		Number Number::ceil() {
-			std::cerr << "Unimplemented: " << __func__ << std::endl;
-			// ceil(n) = floor(n) + 1
-			return 0;
+			Number result = *this;
+			result.rescale(0, CEILING);
+			
+			return result;
 		}
 		
 		Number Number::absolute() {
-			std::cerr << "Unimplemented: " << __func__ << std::endl;
-			return 0;
+			Number result = *this;
+			result._negative = false;
+			
+			return result;
 		}
 		
 		std::string Number::to_string() const
@@ -141,7 +303,7 @@ namespace Kai {
 			std::size_t width = value_string.size();
 
 			// We might require some leading 0s:
-			if (width < _scale) {
+			if (width <= _scale) {
 				std::string padding(1 + _scale - width, '0');
 				value_string = padding + value_string;
 			}
@@ -21,6 +21,30 @@ namespace Kai {
 		public:
 			typedef int IntermediateT;
 			
+			// How a result is rounded when it has more fractional digits than the requested scale.
+			enum Rounding {
+				// Towards negative infinity.
+				FLOOR,
+				
+				// Towards positive infinity.
+				CEILING,
+				
+				// Towards zero, i.e. the extra digits are truncated.
+				DOWN,
+				
+				// Away from zero.
+				UP,
+				
+				// To the nearest value, and away from zero if it is half way between two values.
+				HALF_UP,
+				
+				// To the nearest value, and towards zero if it is half way.
+				HALF_DOWN,
+				
+				// To the nearest value, and to the even one if it is half way, which doesn't bias the sum of many rounded values.
+				HALF_EVEN
+			};
+			
 		protected:
 			bool _negative;
 			Integer _value;
@@ -28,6 +52,9 @@ namespace Kai {
 			// Scale is (10 ^ _scale) in base 10.
 			ScaleT _scale;
 			
+			// Zero is never negative.
+			void normalize();
+			
 		public:
 			Number(IntermediateT value = 0);
 			Number(std::string value);
@@ -35,6 +62,9 @@ namespace Kai {
 			
 			int compare_with(const Number & other) const;
 			
+			bool is_negative() const { return _negative; }
+			ScaleT scale() const { return _scale; }
+			
 			Integer fractional_part(const Integer & base = 10);
 			Integer whole_part(const Integer & base = 10);
 			
@@ -42,10 +72,22 @@ namespace Kai {
 			Number ceil();
 			Number absolute();
 			
+			// Changes the number of fractional digits, rounding the value if there are fewer.
+			void rescale(ScaleT scale, Rounding rounding = HALF_EVEN);
+			
 			void multiply(const Number & other);
 			void add(const Number & other);
+			void subtract(const Number & other);
+			
+			// Divides by the other number and rounds the quotient to the given scale. Throws std::runtime_error if the other number is zero.
+			void divide(const Number & other, ScaleT scale, Rounding rounding = HALF_EVEN);
+			
+			// Calculates the square root, rounded to the given scale, using the integer square root. Throws std::domain_error if the number is negative.
+			void square_root(ScaleT scale, Rounding rounding = HALF_EVEN);
 			
 			Number & operator*=(const Number & other) { this->multiply(other); return *this; }
+			Number & operator+=(const Number & other) { this->add(other); return *this; }
+			Number & operator-=(const Number & other) { this->subtract(other); return *this; }
 			
 			std::string to_string() const;
 		};
@@ -22,7 +22,7 @@ namespace Kai {
 		
 		void Collector::traverse(const ObjectAllocation * object) {
 			if (object) {
-				if (!_start->includes(object)) {
+				if (!_start->base_of(object)) {
 					//std::cerr << "Couldn't traverse foreign memory: " << object << " (Potential memory leak)." << std::endl;
 					
 					return;
@@ -60,17 +60,5 @@ namespace Kai {
 			
 			object->_flags |= Memory::DELETED;
 		}
-		
-		void ManagedObject::retain() const {
-			_reference_count += 1;
-			
-			if (_reference_count != 0) this->_flags |= PINNED;
-		}
-		
-		void ManagedObject::release() const {
-			_reference_count -= 1;
-			
-			if (_reference_count == 0) this->_flags &= ~PINNED;
-		}
 	}
 }
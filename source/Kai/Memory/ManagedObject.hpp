@@ -36,8 +36,16 @@ namespace Kai {
 			
 			void operator delete(void *);
 			
-			void retain() const;
-			void release() const;
+			// Referenced objects are pinned, so that they are roots for the collector. The flags are only written when the first reference is taken or the last one is released:
+			void retain() const {
+				if (_reference_count++ == 0)
+					this->_flags |= PINNED;
+			}
+			
+			void release() const {
+				if (--_reference_count == 0)
+					this->_flags &= ~PINNED;
+			}
 			
 			unsigned reference_count() const { return _reference_count; }
 		};
@@ -203,6 +203,7 @@ namespace Kai {
 			
 			PageAllocation * front = new(base) PageAllocation;
 			front->_next_page_allocation = NULL;
+			front->_last_page_allocation = front;
 			front->_flags = FRONT | USED | PINNED;
 			
 			void * top = (ByteT *)base + size - sizeof(PageBoundary);
@@ -249,13 +250,20 @@ namespace Kai {
 
 				// We got to the end of the free list and didn't find anything, we need to try the next page allocation, or possibly allocate a new one.
 				while (!next_free) {
-					if (!base->_next_page_allocation) {
-						PageAllocation * page_allocation = PageAllocation::create(64 * page_size());
-						
-						base->_next_page_allocation = page_allocation;
-						base->_back->_next = page_allocation;
-						base->_next_free = page_allocation->_next_free;
+					if (base == this && _last_page_allocation != this) {
+						// Memory freed by the collector is added to the free list of the first page, so any pages in between are full and can be skipped:
+						base = _last_page_allocation;
 					} else {
+						if (!base->_next_page_allocation) {
+							PageAllocation * page_allocation = PageAllocation::create(64 * page_size());
+							
+							base->_next_page_allocation = page_allocation;
+							base->_back->_next = page_allocation;
+							
+							_last_page_allocation = page_allocation;
+						}
+						
+						// Each page allocation has its own free list:
 						base = base->_next_page_allocation;
 					}
 					
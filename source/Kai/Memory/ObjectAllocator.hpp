@@ -10,6 +10,7 @@
 #define _KAI_MEMORY_OBJECTALLOCATOR_H
 
 #include <iostream>
+#include <stdint.h>
 
 namespace Kai {
 	namespace Memory {
@@ -60,7 +61,10 @@ namespace Kai {
 			friend class Collector;
 			
 			ObjectAllocation * _next;
-			mutable unsigned _flags;
+			mutable uint16_t _flags;
+			
+			/// Identifies the type of the object, if it has one. This fits alongside the flags, so it doesn't make allocations any larger.
+			uint16_t _tag;
 			
 			/// Return the distance in bytes from the start of this allocation to the start of the next.
 			std::size_t memory_size() const;
@@ -99,6 +103,9 @@ namespace Kai {
 			ObjectAllocation * _back;
 			PageAllocation * _next_page_allocation;
 			
+			/// The most recently created page allocation, which is the only one after this page likely to have free memory.
+			PageAllocation * _last_page_allocation;
+			
 			void prepend(FreeAllocation * free_allocation);
 			void check() const;
 			
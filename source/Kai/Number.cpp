@@ -15,6 +15,9 @@
 #include "Symbol.hpp"
 #include "Function.hpp"
 
+#include <algorithm>
+#include <vector>
+
 namespace Kai {
 	
 	const char * const Integral::NAME = "Integral";
@@ -27,12 +30,41 @@ namespace Kai {
 	
 	const char * const Integer::NAME = "Integer";
 	
-	Integer::Integer (ValueT value) : _value(value) {
+	thread_local Math::Workspace Integer::_workspace;
+	
+	Integer::Integer (const ValueT & value) : Object(INTEGER_TAG), _value(value) {
 	}
 	
 	Integer::~Integer () {
 	}
 	
+	static Integer ** create_shared_integers() {
+		Integer ** integers = new Integer * [Integer::SHARED];
+		
+		for (Math::IntermediateT i = 0; i < Integer::SHARED; i += 1) {
+			integers[i] = Object::constant<Integer>(i);
+		}
+		
+		return integers;
+	}
+	
+	Integer * Integer::create(Frame * frame, Math::IntermediateT value) {
+		// Initialised once, on first use:
+		static Integer ** shared = create_shared_integers();
+		
+		if (value < SHARED)
+			return shared[value];
+		
+		return new(frame) Integer(value);
+	}
+	
+	Integer * Integer::create(Frame * frame, const ValueT & value) {
+		if (value.size() == 1 && value[0] < SHARED)
+			return create(frame, value[0]);
+		
+		return new(frame) Integer(value);
+	}
+	
 	Ref<Symbol> Integer::identity(Frame * frame) const {
 		return frame->sym("Integer");
 	}
@@ -41,33 +73,71 @@ namespace Kai {
 		return _value;
 	}
 	
-	Ref<Object> Integer::sum (Frame * frame) {
-		ValueT total = 0;
+	/// Returns true if the value is an integer which fits in a machine word, so that arithmetic on it doesn't need to allocate.
+	static bool to_word(Object * value, Math::IntermediateT & word) {
+		Integer * integer = ptr(value).as<Integer>();
 		
+		if (integer && integer->value().size() <= Math::INTERMEDIATE_DIGITS) {
+			word = integer->value().to_intermediate();
+			
+			return true;
+		}
+		
+		return false;
+	}
+	
+	Ref<Object> Integer::sum (Frame * frame) {
 		// Evaluate the given arguments
-		Cell * args = frame->unwrap();
+		std::size_t count = frame->evaluate_arguments();
+		Object ** arguments = frame->argument_values();
+		
+		// If the arguments and the sum fit in a machine word, there is no need for arbitrary precision:
+		Math::IntermediateT word = 0, value;
+		std::size_t index = 0;
+		
+		while (index < count && to_word(arguments[index], value) && !__builtin_add_overflow(word, value, &word))
+			index += 1;
 		
-		while (args != NULL) {
+		if (index == count)
+			return Integer::create(frame, word);
+		
+		std::vector<const ValueT *> operands;
+		operands.reserve(count);
+		
+		for (index = 0; index < count; index += 1) {
 			// For each argument, extract it as an Integer value
-			Integer * integer = args->head().as<Integer>();
+			Integer * integer = ptr(arguments[index]).as<Integer>();
 			
 			if (integer) {
-				// If it was an integer, add its value to the total
-				total += integer->value();
+				operands.push_back(&integer->value());
 			} else {
 				// If it wasn't an integer, throw an exception.
 				throw Exception("Invalid Integer Value", frame);
 			}
-			
-			// Move to the next argument.
-			args = args->tail().as<Cell>();
 		}
 		
+		// The values are added together in a single pass, rather than one at a time:
+		ValueT total;
+		total.set_sum(operands.data(), operands.size(), _workspace);
+		
 		// Return a new integer with the calculated sum.
-		return new(frame) Integer(total);
+		return Integer::create(frame, total);
 	}
 	
 	Ref<Object> Integer::subtract (Frame * frame) {
+		std::size_t count = frame->evaluate_arguments();
+		Math::IntermediateT word, value;
+		
+		if (count && to_word(frame->argument(0), word)) {
+			std::size_t index = 1;
+			
+			while (index < count && to_word(frame->argument(index), value) && !__builtin_sub_overflow(word, value, &word))
+				index += 1;
+			
+			if (index == count)
+				return Integer::create(frame, word);
+		}
+		
 		ValueT total = 0;
 		Integer * first;
 		
@@ -84,11 +154,21 @@ namespace Kai {
 			total -= integer->value();
 		}
 		
-		return new(frame) Integer(total);
+		return Integer::create(frame, total);
 	}
 	
 	Ref<Object> Integer::product (Frame * frame) {
-		ValueT total = 1;
+		Math::IntermediateT word = 1, value;
+		std::size_t count = frame->evaluate_arguments(), index = 0;
+		
+		while (index < count && to_word(frame->argument(index), value) && !__builtin_mul_overflow(word, value, &word))
+			index += 1;
+		
+		if (index == count)
+			return Integer::create(frame, word);
+		
+		std::vector<const ValueT *> operands;
+		operands.reserve(count);
 		
 		ArgumentExtractor arguments = frame->extract();
 		
@@ -97,29 +177,33 @@ namespace Kai {
 			
 			arguments = arguments(integer, "right-value");
 			
-			total *= integer->value();
+			operands.push_back(&integer->value());
 		}
 		
-		return new(frame) Integer(total);
+		// Multiplying the values one at a time is quadratic in the size of the result, while a product tree keeps the operands of each product balanced:
+		ValueT total;
+		total.set_product(operands.data(), operands.size(), _workspace);
+		
+		return Integer::create(frame, total);
 	}
 	
-	Ref<Object> Integer::modulus (Frame * frame) {
-		Integer * number, * base;
+	Ref<Object> Integer::modulus (Frame * frame, Integer * number, Integer * base) {
+		Math::IntermediateT a, b;
+		
+		if (to_word(number, a) && to_word(base, b) && b != 0)
+			return Integer::create(frame, a % b);
 		
-		frame->extract()(number, "self")(base, "base");
+		Math::Integer quotient, remainder;
+		quotient.set_fraction(number->value(), base->value(), remainder, _workspace);
 		
-		return new(frame) Integer(number->value() % base->value());
+		return Integer::create(frame, remainder);
 	}
 	
-	Ref<Object> Integer::power (Frame * frame) {
-		Integer * base, * exponent;
-		
-		frame->extract()(base, "base")(exponent, "exponent");
-		
+	Ref<Object> Integer::power (Frame * frame, Integer * base, Integer * exponent) {
 		Math::Integer result;
-		result.set_power(base->value(), exponent->value());
+		result.set_power(base->value(), exponent->value(), _workspace);
 		
-		return new(frame) Integer(result);
+		return Integer::create(frame, result);
 	}
 	
 	Ref<Object> Integer::fractional_part(Frame * frame) {
@@ -136,30 +220,21 @@ namespace Kai {
 			result = self->value().fractional_part(scale->to_integer().to_intermediate());
 		}
 		
-		return new(frame) Integer(result);
+		return Integer::create(frame, result);
 	}
 	
-	Ref<Object> Integer::greatest_common_divisor(Frame * frame) {
-		Integer * a = NULL, * b = NULL;
-		
-		frame->extract()(a, "a")(b, "b");
-		
+	Ref<Object> Integer::greatest_common_divisor(Frame * frame, Integer * a, Integer * b) {
 		Math::Integer result;
 		result.calculate_greatest_common_divisor(a->value(), b->value());
 		
-		return new(frame) Integer(result);
+		return Integer::create(frame, result);
 	}
 	
-	Ref<Object> Integer::generate_prime(Frame * frame) {
-		Object * self = NULL;
-		Integral * length = NULL;
-		
-		frame->extract()(self, "self")(length, "word-length");
-		
+	Ref<Object> Integer::generate_prime(Frame * frame, Object * self, Integral * length) {
 		Math::Integer prime;
 		prime.generate_prime(length->to_integer().to_intermediate());
 		
-		return new(frame) Integer(prime);
+		return Integer::create(frame, prime);
 	}
 	
 	Ref<Object> Integer::from_string(Frame * frame) {
@@ -179,7 +254,7 @@ namespace Kai {
 		
 		Math::Integer value(string->value(), base);
 		
-		return new(frame) Integer(value);
+		return Integer::create(frame, value);
 	}
 	
 	Ref<Object> Integer::to_string(Frame * frame) {
@@ -199,11 +274,7 @@ namespace Kai {
 		return new(frame) String(self->value().to_string(base.to_digit()));
 	}
 	
-	Ref<Object> Integer::to_number(Frame * frame) {
-		Integer * self;
-		
-		frame->extract()(self, "self");
-		
+	Ref<Object> Integer::to_number(Frame * frame, Integer * self) {
 		Math::Number value(self->value(), 0);
 		
 		return new(frame) Number(value);
@@ -227,17 +298,17 @@ namespace Kai {
 		prototype->update(frame->sym("+"), KAI_BUILTIN_FUNCTION(Integer::sum));
 		prototype->update(frame->sym("-"), KAI_BUILTIN_FUNCTION(Integer::subtract));
 		prototype->update(frame->sym("*"), KAI_BUILTIN_FUNCTION(Integer::product));
-		prototype->update(frame->sym("%"), KAI_BUILTIN_FUNCTION(Integer::modulus));
-		prototype->update(frame->sym("**"), KAI_BUILTIN_FUNCTION(Integer::power));
+		prototype->update(frame->sym("%"), KAI_TYPED_FUNCTION(Integer::modulus, "self", "base"));
+		prototype->update(frame->sym("**"), KAI_TYPED_FUNCTION(Integer::power, "base", "exponent"));
 		
 		prototype->update(frame->sym("fractional-part"), KAI_BUILTIN_FUNCTION(Integer::fractional_part));
 		
-		prototype->update(frame->sym("generate-prime"), KAI_BUILTIN_FUNCTION(Integer::generate_prime));
-		prototype->update(frame->sym("greatest-common-divisor"), KAI_BUILTIN_FUNCTION(Integer::greatest_common_divisor));
+		prototype->update(frame->sym("generate-prime"), KAI_TYPED_FUNCTION(Integer::generate_prime, "self", "word-length"));
+		prototype->update(frame->sym("greatest-common-divisor"), KAI_TYPED_FUNCTION(Integer::greatest_common_divisor, "a", "b"));
 		
 		prototype->update(frame->sym("from-string"), KAI_BUILTIN_FUNCTION(Integer::from_string));
 		prototype->update(frame->sym("to-string"), KAI_BUILTIN_FUNCTION(Integer::to_string));
-		prototype->update(frame->sym("to-number"), KAI_BUILTIN_FUNCTION(Integer::to_number));
+		prototype->update(frame->sym("to-number"), KAI_TYPED_FUNCTION(Integer::to_number, "self"));
 		
 		prototype->update(frame->sym("radix"), new(frame) Integer(DEFAULT_RADIX));
 		
@@ -248,7 +319,7 @@ namespace Kai {
 	
 	const char * const Number::NAME = "Number";
 	
-	Number::Number(ValueT value) : _value(value)
+	Number::Number(ValueT value) : Object(NUMBER_TAG), _value(value)
 	{
 		
 	}
@@ -299,31 +370,115 @@ namespace Kai {
 		
 		return new(frame) Number(total);
 	}
-
+	
 	Ref<Object> Number::sum (Frame * frame)
 	{
 		ValueT total = 0;
-
+		
 		ArgumentExtractor arguments = frame->extract();
-
+		
 		while (arguments) {
 			Number * number;
-
+			
 			arguments = arguments(number, "right-value");
-
-			//total = total + number->value();
+			
+			total += number->value();
 		}
-
+		
 		return new(frame) Number(total);
 	}
-
+	
+	Ref<Object> Number::subtract (Frame * frame)
+	{
+		Number * first;
+		
+		ArgumentExtractor arguments = frame->extract();
+		arguments = arguments(first, "left-value");
+		
+		ValueT total = first->value();
+		
+		while (arguments) {
+			Number * number;
+			
+			arguments = arguments(number, "right-value");
+			
+			total -= number->value();
+		}
+		
+		return new(frame) Number(total);
+	}
+	
+	static Math::Number::Rounding to_rounding(Frame * frame, Symbol * name) {
+		if (name == NULL)
+			return Math::Number::HALF_EVEN;
+		
+		const StringT & value = name->value();
+		
+		if (value == "floor")
+			return Math::Number::FLOOR;
+		else if (value == "ceiling")
+			return Math::Number::CEILING;
+		else if (value == "down")
+			return Math::Number::DOWN;
+		else if (value == "up")
+			return Math::Number::UP;
+		else if (value == "half-up")
+			return Math::Number::HALF_UP;
+		else if (value == "half-down")
+			return Math::Number::HALF_DOWN;
+		else if (value == "half-even")
+			return Math::Number::HALF_EVEN;
+		
+		throw Exception("Invalid Rounding Mode", name, frame);
+	}
+	
+	static Math::ScaleT to_scale(Integral * scale, Math::ScaleT minimum) {
+		if (scale)
+			return scale->to_integer().to_intermediate();
+		
+		return std::max<Math::ScaleT>(minimum, Number::DEFAULT_SCALE);
+	}
+	
 	Ref<Object> Number::fraction (Frame * frame)
 	{
 		Number * numerator, * denominator;
-		frame->extract()(numerator, "numerator")(denominator, "denominator");
-
-		//return new(frame) Number(numerator->value() / denominator->value());
-		return nullptr;
+		Integral * scale = NULL;
+		Symbol * rounding = NULL;
+		
+		frame->extract()(numerator, "numerator")(denominator, "denominator")[scale][rounding];
+		
+		ValueT result = numerator->value();
+		result.divide(denominator->value(), to_scale(scale, std::max(numerator->value().scale(), denominator->value().scale())), to_rounding(frame, rounding));
+		
+		return new(frame) Number(result);
+	}
+	
+	Ref<Object> Number::square_root (Frame * frame)
+	{
+		Number * self;
+		Integral * scale = NULL;
+		Symbol * rounding = NULL;
+		
+		frame->extract()(self, "self")[scale][rounding];
+		
+		ValueT result = self->value();
+		result.square_root(to_scale(scale, result.scale()), to_rounding(frame, rounding));
+		
+		return new(frame) Number(result);
+	}
+	
+	Ref<Object> Number::round (Frame * frame)
+	{
+		Number * self;
+		Integral * scale;
+		Symbol * rounding = NULL;
+		
+		frame->extract()(self, "self")(scale, "scale")[rounding];
+		
+		ValueT result = self->value();
+		result.rescale(scale->to_integer().to_intermediate(), to_rounding(frame, rounding));
+		
+		return new(frame) Number(result);
 	}
 	
 	void Number::import (Frame * frame) {
@@ -331,7 +486,10 @@ namespace Kai {
 		
 		prototype->update(frame->sym("*"), KAI_BUILTIN_FUNCTION(Number::product));
 		prototype->update(frame->sym("+"), KAI_BUILTIN_FUNCTION(Number::sum));
+		prototype->update(frame->sym("-"), KAI_BUILTIN_FUNCTION(Number::subtract));
 		prototype->update(frame->sym("/"), KAI_BUILTIN_FUNCTION(Number::fraction));
+		prototype->update(frame->sym("square-root"), KAI_BUILTIN_FUNCTION(Number::square_root));
+		prototype->update(frame->sym("round"), KAI_BUILTIN_FUNCTION(Number::round));
 		
 		frame->update(frame->sym("Number"), prototype);
 	}
@@ -29,15 +29,25 @@ namespace Kai {
 		
 		enum { DEFAULT_RADIX = 16 };
 		
+		/// Integers below this are shared constants, so that most arithmetic on counters and indices doesn't allocate.
+		enum { SHARED = 1024 };
+		
 	protected:
 		ValueT _value;
 		
+		/// Scratch memory for the arithmetic builtins, which is kept between calls so that they don't allocate temporaries.
+		static thread_local Math::Workspace _workspace;
+		
 	public:
 		static const char * const NAME;
 		
-		Integer (ValueT value);
+		Integer (const ValueT & value);
 		virtual ~Integer ();
 		
+		/// Returns a shared constant if the value is small enough, otherwise allocates a new integer. Integers are never modified once they have been created, so sharing them is safe.
+		static Integer * create(Frame * frame, Math::IntermediateT value);
+		static Integer * create(Frame * frame, const ValueT & value);
+		
 		virtual Ref<Symbol> identity(Frame * frame) const;
 		
 		virtual Math::Integer to_integer() const;
@@ -52,18 +62,20 @@ namespace Kai {
 		static Ref<Object> sum(Frame * frame);
 		static Ref<Object> product(Frame * frame);
 		static Ref<Object> subtract(Frame * frame);
-		static Ref<Object> modulus(Frame * frame);
-		static Ref<Object> power(Frame * frame);
+		
+		// These functions have a fixed number of arguments, which are unpacked by KAI_TYPED_FUNCTION:
+		static Ref<Object> modulus(Frame * frame, Integer * self, Integer * base);
+		static Ref<Object> power(Frame * frame, Integer * base, Integer * exponent);
 		
 		static Ref<Object> fractional_part(Frame * frame);
 		
-		static Ref<Object> greatest_common_divisor(Frame * frame);
-		static Ref<Object> generate_prime(Frame * frame);
+		static Ref<Object> greatest_common_divisor(Frame * frame, Integer * a, Integer * b);
+		static Ref<Object> generate_prime(Frame * frame, Object * self, Integral * length);
 		
 		static Ref<Object> from_string(Frame * frame);
 		static Ref<Object> to_string(Frame * frame);
 		
-		static Ref<Object> to_number(Frame * frame);
+		static Ref<Object> to_number(Frame * frame, Integer * self);
 		
 		static void import(Frame * frame);
 	};
@@ -72,6 +84,9 @@ namespace Kai {
 	public:
 		typedef Math::Number ValueT;
 		
+		/// Quotients and square roots have at least this many fractional digits, unless a scale is given.
+		enum { DEFAULT_SCALE = 16 };
+		
 	protected:
 		ValueT _value;
 		
@@ -94,7 +109,12 @@ namespace Kai {
 		
 		static Ref<Object> product(Frame * frame);
 		static Ref<Object> sum(Frame * frame);
+		static Ref<Object> subtract(Frame * frame);
+		
+		/// The optional rounding mode is one of `floor, `ceiling, `down, `up, `half-up, `half-down or `half-even, which is the default.
 		static Ref<Object> fraction(Frame * frame);
+		static Ref<Object> square_root(Frame * frame);
+		static Ref<Object> round(Frame * frame);
 		
 		static void import(Frame * frame);
 	};
@@ -13,6 +13,7 @@
 #include "Frame.hpp"
 #include "Function.hpp"
 #include "Number.hpp"
+#include "Logic.hpp"
 
 namespace Kai
 {
@@ -27,11 +28,11 @@ namespace Kai
 	}
 	
 	Ref<Object> Object::prototype(Frame * frame) const {
-		return frame->lookup(identity(frame));
+		return Prototypes::lookup(frame, this);
 	}
 	
 	Ref<Object> Object::lookup(Frame * frame, Symbol * identifier) {
-		if (Object::equal(identifier, identity(frame))) {
+		if (Prototypes::identifies(frame, this, identifier)) {
 			return NULL;
 		}
 		
@@ -112,7 +113,7 @@ namespace Kai
 			throw Exception("Invalid Comparison", frame);
 		}
 		
-		return new(frame) Integer(c);
+		return Integer::create(frame, c);
 	}
 	
 	Ref<Object> Object::equal(Frame * frame) {
@@ -129,7 +130,7 @@ namespace Kai
 		}
 		
 		if (c == EQUAL) {
-			return frame->sym("true");
+			return Symbol::true_symbol(frame);
 		} else {
 			return NULL;
 		}
@@ -162,29 +163,33 @@ namespace Kai
 		return NULL;
 	}
 	
+	// Each name is evaluated in the scope of the previous value, using transient frames which only exist for the duration of the lookup.
+	static Ref<Object> lookup_path(Frame * frame, Cell * cur) {
+		if (!cur->head()) {
+			throw Exception("Invalid Name", cur, frame);
+		}
+		
+		Ref<Object> value = cur->head()->evaluate(frame);
+		
+		Cell * tail = cur->tail().as<Cell>();
+		if (!tail || Return::pending()) return value;
+		
+		if (!value) {
+			throw Exception("Null Scope", cur->head(), frame);
+		}
+		
+		TransientFrame next(value, frame);
+		
+		return lookup_path(&next, tail);
+	}
+	
 	Ref<Object> Object::lookup(Frame * frame) {		
 		Cell * cur = frame->operands();
-		Ref<Object> value = NULL;
-		
-		while (cur) {
-			if (!cur->head()) {
-				throw Exception("Invalid Name", cur, frame);
-			}
-			
-			value = cur->head()->evaluate(frame);
-			
-			Cell * tail = cur->tail().as<Cell>();
-			if (!tail) break;
-			
-			if (!value) {
-				throw Exception("Null Scope", cur->head(), frame);
-			}
-			
-			frame = new(frame) Frame(value, frame);
-			cur = tail;
-		}
 		
-		return value;
+		if (cur)
+			return lookup_path(frame, cur);
+		else
+			return NULL;
 	}
 	
 	Ref<Object> Object::call(Frame * frame) {
@@ -193,6 +198,10 @@ namespace Kai
 		
 		frame->extract()(self, "self")(body, "body");
 		
+		return send(frame, self, body);
+	}
+	
+	Ref<Object> Object::send(Frame * frame, Object * self, Cell * body) {
 		// Wrap self so we can pass it to other functions
 		self = self->as_value(frame);
 		
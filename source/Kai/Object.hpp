@@ -14,11 +14,78 @@
 #include "Memory/ManagedObject.hpp"
 
 #include <set>
+#include <type_traits>
+#include <utility>
 
 namespace Kai {
 	
 	class Object;
 	
+	/// Tags which identify the built-in types, so that they can be checked without RTTI. A derived type follows its base type, so that checking for the base type is a range check.
+	enum TypeTag : uint16_t {
+		OBJECT_TAG = 0,
+		
+		CELL_TAG,
+		SYMBOL_TAG,
+		LEXICAL_SYMBOL_TAG,
+		TABLE_TAG,
+		STRING_TAG,
+		INTEGER_TAG,
+		NUMBER_TAG,
+		ARRAY_TAG,
+		
+		LAMBDA_TAG,
+		LOCALS_TAG,
+		FRAME_TAG,
+		TRANSIENT_FRAME_TAG,
+		CODE_TAG,
+		
+		TYPE_TAGS
+	};
+	
+	/// The range of tags used by the given type and the types derived from it. Types without tags are checked using dynamic_cast.
+	template <typename ObjectT>
+	struct TypeTags {
+		static constexpr bool TAGGED = false;
+	};
+	
+#define KAI_TYPE_TAGS(type, first, last) \
+	template <> struct TypeTags<type> { \
+		static constexpr bool TAGGED = true; \
+		static constexpr TypeTag FIRST = first, LAST = last; \
+	}
+	
+	class Cell;
+	class Symbol;
+	class LexicalSymbol;
+	class Table;
+	class String;
+	class Integer;
+	class Number;
+	class Array;
+	class Lambda;
+	class Locals;
+	class Frame;
+	class TransientFrame;
+	
+	namespace Bytecode {
+		class Code;
+	}
+	
+	KAI_TYPE_TAGS(Cell, CELL_TAG, CELL_TAG);
+	KAI_TYPE_TAGS(Symbol, SYMBOL_TAG, LEXICAL_SYMBOL_TAG);
+	KAI_TYPE_TAGS(LexicalSymbol, LEXICAL_SYMBOL_TAG, LEXICAL_SYMBOL_TAG);
+	KAI_TYPE_TAGS(Table, TABLE_TAG, TABLE_TAG);
+	KAI_TYPE_TAGS(String, STRING_TAG, STRING_TAG);
+	KAI_TYPE_TAGS(Integer, INTEGER_TAG, INTEGER_TAG);
+	KAI_TYPE_TAGS(Number, NUMBER_TAG, NUMBER_TAG);
+	KAI_TYPE_TAGS(Array, ARRAY_TAG, ARRAY_TAG);
+	KAI_TYPE_TAGS(Lambda, LAMBDA_TAG, LAMBDA_TAG);
+	KAI_TYPE_TAGS(Locals, LOCALS_TAG, LOCALS_TAG);
+	KAI_TYPE_TAGS(Frame, FRAME_TAG, TRANSIENT_FRAME_TAG);
+	KAI_TYPE_TAGS(TransientFrame, TRANSIENT_FRAME_TAG, TRANSIENT_FRAME_TAG);
+	KAI_TYPE_TAGS(Bytecode::Code, CODE_TAG, CODE_TAG);
+	
 	/// Object Comparison helpers.
 	class InvalidComparison {};
 	
@@ -35,7 +102,7 @@ namespace Kai {
 	
 	template <typename ThisT>
 	inline static ComparisonResult derived_compare(const ThisT * lhs, const Object * rhs) {
-		const ThisT * other = dynamic_cast<const ThisT *>(rhs);
+		const ThisT * other = TypeCast<ThisT, Object>::cast(const_cast<Object *>(rhs));
 		
 		if (other) {
 			return lhs->compare(other);
@@ -46,6 +113,7 @@ namespace Kai {
 	
 	class Symbol;
 	class Frame;
+	class Cell;
 	
 	/** An object specifies the default behaviour for all objects in Kai.
 	 
@@ -55,8 +123,38 @@ namespace Kai {
 	public:
 		static const char * const NAME;
 		
+		explicit Object(TypeTag tag = OBJECT_TAG) {
+			_tag = tag;
+		}
+		
+		Object(Object & other) : Memory::ManagedObject(other) {
+			_tag = other._tag;
+		}
+		
 		virtual ~Object();
 		
+		TypeTag tag() const { return (TypeTag)_tag; }
+		
+		/// Allocates an object outside of the collected heap, so that it is never collected and can be shared by every interpreter, e.g. the symbol true. It must not refer to any collected object.
+		template <typename ObjectT, typename... ArgumentsT>
+		static ObjectT * constant(ArgumentsT &&... arguments) {
+			// The collector doesn't traverse memory that it didn't allocate:
+			ObjectT * object = ::new ObjectT(std::forward<ArgumentsT>(arguments)...);
+			
+			object->_next = NULL;
+			object->_flags = 0;
+			
+			return object;
+		}
+		
+		/// Returns true if the object is of the given type, which must have type tags.
+		template <typename ObjectT>
+		bool is() const {
+			typedef TypeTags<ObjectT> TagsT;
+			
+			return (unsigned)(_tag - TagsT::FIRST) <= (unsigned)(TagsT::LAST - TagsT::FIRST);
+		}
+		
 		virtual Ref<Symbol> identity(Frame * frame) const;
 		
 		/// A prototype specifies the behaviour of the current value, and is potentially context dependent.
@@ -135,9 +233,31 @@ namespace Kai {
 		// Performs a method call with the given function.
 		static Ref<Object> call(Frame * frame);
 		
+		/// Performs the method call (self body), with arguments which have already been evaluated.
+		static Ref<Object> send(Frame * frame, Object * self, Cell * body);
+		
 		static void import(Frame * frame);
 	};
 	
+	/// Built-in types are checked using their type tags. Conversions to a base type don't need to be checked.
+	template <typename ToT, typename FromT>
+	struct TypeCast<ToT, FromT, typename std::enable_if<TypeTags<ToT>::TAGGED && std::is_base_of<Object, FromT>::value>::type> {
+		static ToT * cast(FromT * object, std::true_type) {
+			return object;
+		}
+		
+		static ToT * cast(FromT * object, std::false_type) {
+			if (object && object->template is<ToT>())
+				return static_cast<ToT *>(static_cast<Object *>(object));
+			
+			return NULL;
+		}
+		
+		static ToT * cast(FromT * object) {
+			return cast(object, std::is_base_of<ToT, FromT>());
+		}
+	};
+	
 }
 
 #endif
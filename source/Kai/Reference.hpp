@@ -19,6 +19,14 @@
 
 namespace Kai {
 	
+	/// Converts a pointer to a related type, returning NULL if the object isn't of that type. Object.hpp specialises this so that built-in types are checked using their type tags rather than RTTI.
+	template <typename ToT, typename FromT, typename EnableT = void>
+	struct TypeCast {
+		static ToT * cast(FromT * object) {
+			return dynamic_cast<ToT *>(object);
+		}
+	};
+	
 	template <typename ObjectT>
 	class Pointer {
 	protected:
@@ -32,11 +40,11 @@ namespace Kai {
 		}
 		
 		template <typename OtherObjectT>
-		Pointer (OtherObjectT* object) : _object(dynamic_cast<ObjectT*>(object)) {
+		Pointer (OtherObjectT* object) : _object(TypeCast<ObjectT, OtherObjectT>::cast(object)) {
 		}
 		
 		template <typename OtherObjectT>
-		Pointer (Pointer<OtherObjectT> other) : _object(dynamic_cast<ObjectT*>(other.get())) {
+		Pointer (Pointer<OtherObjectT> other) : _object(TypeCast<ObjectT, OtherObjectT>::cast(other.get())) {
 		}
 		
 		ObjectT* operator-> () const {
@@ -59,12 +67,12 @@ namespace Kai {
 		
 		template <typename AnyT>
 		AnyT * as () {
-			return dynamic_cast<AnyT *>(this->_object);
+			return TypeCast<AnyT, ObjectT>::cast(this->_object);
 		}
 		
 		template <typename AnyT>
 		const AnyT * as () const {
-			return dynamic_cast<const AnyT *>(this->_object);
+			return TypeCast<AnyT, ObjectT>::cast(const_cast<ObjectT *>(this->_object));
 		}
 		
 		bool operator== (const Pointer & other) const
@@ -113,6 +121,10 @@ namespace Kai {
 	template <typename ObjectT>
 	using Ptr = Pointer<ObjectT>;
 	
+	/// A pointer to an object which is owned by something else, e.g. the head of a cell. Returning or passing a borrowed object doesn't change its reference count, so it should be used when the owner is known to outlive the borrower.
+	template <typename ObjectT>
+	using Borrowed = Pointer<ObjectT>;
+	
 	template <typename ObjectT>
 	Ptr<ObjectT> ptr(ObjectT * object) {
 		return object;
@@ -145,6 +157,14 @@ namespace Kai {
 			}
 		}
 		
+		/// Give up ownership of the object without releasing it, and return it. The caller becomes responsible for releasing it.
+		ObjectT* detach () {
+			ObjectT* object = this->_object;
+			this->_object = NULL;
+			
+			return object;
+		}
+		
 		Reference& set (ObjectT* object) {
 			clear();
 			
@@ -165,6 +185,17 @@ namespace Kai {
 			construct();
 		}
 		
+		/// Moving a reference transfers ownership of the object, so its reference count isn't changed.
+		Reference (Reference&& other) : Pointer<ObjectT>(other.detach()) {
+		}
+		
+		template <typename OtherObjectT>
+		Reference (Reference<OtherObjectT>&& other) : Pointer<ObjectT>(other.get()) {
+			// If the object isn't of the expected type, the other reference still owns it:
+			if (this->_object)
+				other.detach();
+		}
+		
 		template <typename OtherObjectT>
 		Reference (Pointer<OtherObjectT> other) : Pointer<ObjectT>(other.get()) {
 			construct();
@@ -174,6 +205,16 @@ namespace Kai {
 			return set(other.get());
 		}
 		
+		Reference& operator= (Reference&& other) {
+			if (this != &other) {
+				clear();
+				
+				this->_object = other.detach();
+			}
+			
+			return *this;
+		}
+		
 		template <typename OtherObjectT>
 		Reference& operator= (Pointer<OtherObjectT>& other) {
 			return set(other.get());
@@ -185,7 +226,7 @@ namespace Kai {
 		
 		template <typename OtherObjectT>
 		Reference& operator= (OtherObjectT* object) {
-			return set(dynamic_cast<ObjectT*>(object));
+			return set(TypeCast<ObjectT, OtherObjectT>::cast(object));
 		}
 		
 		~Reference () {
@@ -220,7 +220,7 @@ namespace Kai {
 		SourceCode * source_code;
 		frame->extract()(source_code);
 		
-		return new(frame) Integer(source_code->number_of_lines());
+		return Integer::create(frame, source_code->number_of_lines());
 	}
 	
 	Ref<Symbol> SourceCode::identity(Frame * frame) const {
@@ -23,7 +23,7 @@ namespace Kai {
 	
 	const char * const String::NAME = "String";
 	
-	String::String (const StringT & value, bool unescape) : _value(value) {
+	String::String (const StringT & value, bool unescape) : Object(STRING_TAG), _value(value) {
 		if (unescape) {
 			_value = Parser::unescape_string(_value);
 		}
@@ -61,20 +61,19 @@ namespace Kai {
 		StringStreamT buffer;
 		String * self;
 		
-		Cell * next = frame->extract()(self, "self");
+		frame->extract()(self, "self");
 		
 		buffer << self->value();
 		
-		while (next != NULL) {
-			String * head = next->head().as<String>();
+		for (std::size_t index = 1; index < frame->argument_count(); index += 1) {
+			Object * argument = frame->argument(index);
+			String * head = ptr(argument).as<String>();
 			
 			if (head) {
 				buffer << head->value();
 			} else {
-				buffer << Object::to_string(frame, next->head());
+				buffer << Object::to_string(frame, argument);
 			}
-			
-			next = next->tail().as<Cell>();
 		}
 		
 		return new(frame) String(buffer.str());
@@ -84,7 +83,7 @@ namespace Kai {
 		String * self;
 		frame->extract()(self, "self");
 		
-		return new(frame) Integer(self->value().size());
+		return Integer::create(frame, self->value().size());
 	}
 	
 	Ref<Object> String::at (Frame * frame) {
@@ -109,7 +108,7 @@ namespace Kai {
 		
 		std::size_t result = utf8::distance(self->_value.begin(), self->_value.end());
 		
-		return new(frame) Integer(result);
+		return Integer::create(frame, result);
 	}
 	
 	Ref<Object> String::each (Frame * frame) {
@@ -138,15 +137,15 @@ namespace Kai {
 		
 		return first;
 	}
-
+	
 	Ref<Object> String::fixed_width(Frame * frame) {
 		String * self;
-
+		
 		frame->extract()(self, "self");
-
+		
 		std::size_t width = Unicode::fixed_width(self->value());
-
-		return new(frame) Integer(width);
+		
+		return Integer::create(frame, width);
 	}
 	
 	Ref<Object> String::heredoc(Frame * frame) {
@@ -173,9 +172,9 @@ namespace Kai {
 		frame->update(frame->sym("String"), prototype);
 		frame->update(frame->sym("heredoc"), KAI_BUILTIN_FUNCTION(String::heredoc));
 	}
-
+	
 // MARK: -
-
+	
 	const char * const StringBuffer::NAME = "StringBuffer";
 	
 	StringBuffer::StringBuffer() {
@@ -228,6 +227,6 @@ namespace Kai {
 		
 		frame->update(frame->sym("StringBuffer"), prototype);
 	}
-
+	
 	
 }
@@ -16,19 +16,21 @@ namespace Kai {
 	
 	const char * const Symbol::NAME = "Symbol";
 	
+	// FNV-1a, so that names which are anagrams of each other don't collide.
 	HashT Symbol::calculate_hash(const char * value) {
-		HashT sum = 0;
+		HashT hash = 14695981039346656037ULL;
 		
 		while (*value) {
-			sum += *value;
+			hash ^= (unsigned char)*value;
+			hash *= 1099511628211ULL;
 			
 			++value;
 		}
 		
-		return sum;
+		return hash;
 	}
 	
-	Symbol::Symbol(const StringT & value) : _value(value), _hash(calculate_hash(value.c_str())) {
+	Symbol::Symbol(const StringT & value) : Object(SYMBOL_TAG), _value(value), _hash(calculate_hash(value.c_str())) {
 		
 	}
 	
@@ -67,15 +69,21 @@ namespace Kai {
 	}
 	
 	Symbol * Symbol::nil_symbol(Frame * frame) {
-		return frame->sym("nil");
+		static Symbol * symbol = constant<Symbol>("nil");
+		
+		return symbol;
 	}
 	
 	Symbol * Symbol::false_symbol(Frame * frame) {
-		return frame->sym("false");
+		static Symbol * symbol = constant<Symbol>("false");
+		
+		return symbol;
 	}
 	
 	Symbol * Symbol::true_symbol(Frame * frame) {
-		return frame->sym("true");
+		static Symbol * symbol = constant<Symbol>("true");
+		
+		return symbol;
 	}
 	
 	Ref<Object> Symbol::hash(Frame * frame) {
@@ -83,7 +91,7 @@ namespace Kai {
 		
 		frame->extract()(self, "self");
 		
-		return new(frame) Integer(self->_hash);
+		return Integer::create(frame, self->_hash);
 	}
 	
 	Ref<Object> Symbol::assign(Frame * frame) {
@@ -92,13 +100,7 @@ namespace Kai {
 		
 		frame->extract()(self, "self")[value];
 		
-		Table * scope = ptr(frame->scope()).as<Table>();
-		
-		if (scope) {
-			scope->update(self, value);
-		} else {
-			throw Exception("Invalid Scope", frame->scope(), frame);
-		}
+		frame->update(self, value, true);
 		
 		return value;
 	}
@@ -112,6 +114,108 @@ namespace Kai {
 		frame->update(frame->sym("Symbol"), prototype);
 	}
 	
+// MARK: -
+	
+	Bindings::GenerationT Bindings::_generations[BUCKETS];
+	std::size_t Bindings::_definitions[BUCKETS];
+	Object * Bindings::_values[BUCKETS];
+	
+	void Bindings::define(const Symbol * name, Object * value) {
+		std::size_t index = bucket(name);
+		
+		if (_definitions[index] == 0) {
+			_values[index] = value;
+		} else if (_values[index] != value) {
+			_values[index] = NULL;
+		}
+		
+		if (_definitions[index] != IMPLICIT)
+			_definitions[index] += 1;
+		
+		_generations[index] += 1;
+	}
+	
+	void Bindings::update(const Symbol * name, Object * value) {
+		std::size_t index = bucket(name);
+		
+		// If this is the only binding, its value is known exactly:
+		if (_definitions[index] == 1) {
+			_values[index] = value;
+		} else if (_values[index] != value) {
+			_values[index] = NULL;
+		}
+		
+		_generations[index] += 1;
+	}
+	
+	void Bindings::undefine(const Symbol * name) {
+		std::size_t index = bucket(name);
+		
+		if (_definitions[index] != IMPLICIT) {
+			_definitions[index] -= 1;
+			
+			if (_definitions[index] == 0)
+				_values[index] = NULL;
+		}
+		
+		_generations[index] += 1;
+	}
+	
+	void Bindings::define_implicitly(const Symbol * name) {
+		std::size_t index = bucket(name);
+		
+		if (_definitions[index] != IMPLICIT) {
+			_definitions[index] = IMPLICIT;
+			_values[index] = NULL;
+			_generations[index] += 1;
+		}
+	}
+	
+// MARK: -
+	
+	Prototypes::Slot Prototypes::_slots[TYPE_TAGS];
+	
+	Ref<Object> Prototypes::lookup(Frame * frame, const Object * object) {
+		TypeTag tag = object->tag();
+		Slot & slot = _slots[tag];
+		
+		if (slot.prototype && slot.generation == Bindings::generation(Bindings::bucket(slot.hash)))
+			return slot.prototype;
+		
+		Ref<Symbol> name = object->identity(frame);
+		
+		std::size_t bucket = Bindings::bucket(name);
+		Bindings::GenerationT generation = Bindings::generation(bucket);
+		
+		Frame * scope = NULL;
+		Ref<Object> result = frame->lookup(name, scope);
+		
+		if (tag != OBJECT_TAG && scope && scope->top() && Bindings::unique(bucket, result)) {
+			slot.prototype = result;
+			slot.generation = generation;
+			slot.named = true;
+			slot.hash = name->hash();
+		}
+		
+		return result;
+	}
+	
+	bool Prototypes::identifies(Frame * frame, const Object * object, Symbol * identifier) {
+		TypeTag tag = object->tag();
+		Slot & slot = _slots[tag];
+		
+		if (tag != OBJECT_TAG && !slot.named) {
+			slot.named = true;
+			slot.hash = object->identity(frame)->hash();
+		}
+		
+		// Most identifiers can be ruled out without allocating the identity:
+		if (slot.named && slot.hash != identifier->hash())
+			return false;
+		
+		return Object::equal(identifier, object->identity(frame));
+	}
+	
 // MARK: -
 	
 	// This implementation is incomplete.
@@ -34,6 +34,7 @@ namespace Kai {
 		
 		HashT hash() const { return _hash; }
 		
+		/// These symbols are constants, so they can be returned without allocating.
 		static Symbol * nil_symbol(Frame * frame);
 		static Symbol * false_symbol(Frame * frame);
 		static Symbol * true_symbol(Frame * frame);
@@ -51,6 +52,66 @@ namespace Kai {
 		static void import(Frame * frame);
 	};
 	
+	/** Tracks the bindings of each name, so that a lookup can be cached while every binding of its name has the same value.
+	 
+	 Names are grouped into buckets by hash. Any change to a binding advances the generation of its bucket, which invalidates the cached lookups of every name in the bucket.
+	 */
+	class Bindings {
+	public:
+		typedef std::size_t GenerationT;
+		
+		enum { BUCKETS = 4096 };
+		
+		static std::size_t bucket(HashT hash) { return hash % BUCKETS; }
+		static std::size_t bucket(const Symbol * name) { return bucket(name->hash()); }
+		static GenerationT generation(std::size_t bucket) { return _generations[bucket]; }
+		
+		/// True if every binding of the names in the bucket has the given value.
+		static bool unique(std::size_t bucket, Object * value) { return value && _values[bucket] == value; }
+		
+		static void define(const Symbol * name, Object * value);
+		static void update(const Symbol * name, Object * value);
+		static void undefine(const Symbol * name);
+		
+		/// The name is bound without a table, e.g. as the argument of a lambda, so lookups of it are never cached.
+		static void define_implicitly(const Symbol * name);
+		
+	protected:
+		static const std::size_t IMPLICIT = ~(std::size_t)0;
+		
+		static GenerationT _generations[BUCKETS];
+		static std::size_t _definitions[BUCKETS];
+		
+		/// The value of every binding in the bucket, or NULL if they differ.
+		static Object * _values[BUCKETS];
+	};
+	
+	/** Caches the prototype of each built-in type, so that sending a message to a value doesn't allocate its identity and look it up in every enclosing scope.
+	 
+	 Like a call site, a prototype is only cached if it was found in the global scope and every binding of its name has the same value. Redefining the prototype changes the generation of its bucket, which discards the cached value.
+	 */
+	class Prototypes {
+	public:
+		/// Returns the prototype of the given value.
+		static Ref<Object> lookup(Frame * frame, const Object * object);
+		
+		/// True if the identifier is the identity of the given value.
+		static bool identifies(Frame * frame, const Object * object, Symbol * identifier);
+		
+	protected:
+		struct Slot {
+			Object * prototype;
+			Bindings::GenerationT generation;
+			
+			/// Every value with the same tag has the same identity, so its hash never changes once it is known.
+			bool named;
+			HashT hash;
+		};
+		
+		/// Values without a tag have many different identities, so nothing is cached for them.
+		static Slot _slots[TYPE_TAGS];
+	};
+	
 	class Cell;
 	
 	class SymbolTable : public Object {
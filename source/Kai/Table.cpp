@@ -16,7 +16,7 @@ namespace Kai {
 	
 	const char * const Table::NAME = "Table";
 	
-	Table::Table(int size) : _prototype(NULL) {
+	Table::Table(int size) : Object(TABLE_TAG), _prototype(NULL) {
 		KAI_ENSURE(size >= 1);
 		
 		_bins.resize(size);
@@ -88,6 +88,9 @@ namespace Kai {
 				if (key->compare(bin->key) == 0) {
 					Ref<Object> old = bin->value;
 					
+					if (bin->value != value)
+						Bindings::update(key, value);
+					
 					bin->value = value;
 					
 					return old;
@@ -112,6 +115,8 @@ namespace Kai {
 			_bins[index] = next;
 		}
 		
+		Bindings::define(key, value);
+		
 		return NULL;
 	}
 	
@@ -126,6 +131,8 @@ namespace Kai {
 			if (key->compare(bin->key) == 0) {
 				// If key is the same, remove the bin, but skipping over it.
 				*next = bin->next;
+				
+				Bindings::undefine(key);
 			}
 			
 			next = &bin->next;
@@ -196,16 +203,16 @@ namespace Kai {
 	
 	Ref<Object> Table::new_(Frame * frame) {
 		Table * table = new(frame) Table;
-		Cell * args = frame->unwrap();
+		Object * self = NULL;
 		
 		// Bump self
-		args = args->tail().as<Cell>();
+		ArgumentExtractor arguments = frame->extract()[self];
 		
-		while (args) {
+		while (arguments) {
 			Symbol * key = NULL;
 			Object * value = NULL;
 			
-			args = args->extract(frame)[key][value];
+			arguments = arguments[key][value];
 			
 			if (key == NULL) {
 				throw Exception("Invalid Key", frame);
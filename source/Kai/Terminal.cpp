@@ -15,6 +15,7 @@
 #include "Number.hpp"
 #include "Frame.hpp"
 #include "Symbol.hpp"
+#include "Logic.hpp"
 #include "Parser/Expressions.hpp"
 
 // run_code includes garbage collection
@@ -53,6 +54,11 @@ namespace Kai {
 			if (value) {
 				result = value->evaluate(frame);
 			}
+			
+			// A return outside of any block completes here:
+			if (Return::pending()) {
+				result = Return::complete();
+			}
 
 			// Save the result of the expression into the special variable "_":
 			frame->update(frame->sym("_"), result);
@@ -65,6 +71,9 @@ namespace Kai {
 		} catch (Exception & ex) {
 			// Execution failed
 			status = 1;
+			
+			// Discard any return which was interrupted by the exception:
+			Return::complete();
 
 			if (value) {
 				std::cerr << "Executing : " << Object::to_string(frame, value) << std::endl;
@@ -278,7 +287,7 @@ namespace Kai {
 		
 		Terminal::Size size = terminal->size();
 		
-		return Cell::create(frame)(new(frame) Integer(size.width))(new(frame) Integer(size.height));
+		return Cell::create(frame)(Integer::create(frame, size.width))(Integer::create(frame, size.height));
 	}
 	
 	Ref<Object> Terminal::is_tty(Frame * frame) {
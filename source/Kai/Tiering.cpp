@@ -0,0 +1,170 @@
+//
+//  Tiering.cpp
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#include "Tiering.hpp"
+#include "Frame.hpp"
+#include "Function.hpp"
+#include "Lambda.hpp"
+#include "Number.hpp"
+#include "String.hpp"
+#include "Bytecode/Compiler.hpp"
+
+#include <limits>
+
+namespace Kai {
+	
+	NativeCode::~NativeCode() {
+	}
+	
+// MARK: -
+	
+	const char * const Tiering::NAME = "Tiering";
+	
+	static const Tiering::CountT NEVER = std::numeric_limits<Tiering::CountT>::max();
+	
+	// Compiling to bytecode is cheap, but native code is only worth generating for code which is very hot:
+	Tiering::CountT Tiering::_thresholds[TIERS] = {1000, 100000, NEVER};
+	Tiering::NativeCompilerT Tiering::_native_compiler = NULL;
+	
+	Tiering::Tier Tiering::_current = INTERPRETED;
+	Time Tiering::_since;
+	Time Tiering::_time[TIERS] = {Time(0), Time(0), Time(0)};
+	
+	Tiering * Tiering::_shared = NULL;
+	
+	Tiering::Tiering() {
+	}
+	
+	Tiering::~Tiering() {
+	}
+	
+	Ref<Symbol> Tiering::identity(Frame * frame) const {
+		return frame->sym(NAME);
+	}
+	
+	void Tiering::mark(Memory::Traversal * traversal) const {
+		for (Lambda * lambda : _promoted) {
+			traversal->traverse(lambda);
+		}
+	}
+	
+	const char * Tiering::name(Tier tier) {
+		switch (tier) {
+			case INTERPRETED: return "interpreted";
+			case COMPILED: return "compiled";
+			case NATIVE: return "native";
+		}
+		
+		return "unknown";
+	}
+	
+	Tiering::Tier Tiering::switch_to(Tier tier) {
+		Tier previous = _current;
+		Time now;
+		
+		_time[previous] += (now - _since);
+		
+		_since = now;
+		_current = tier;
+		
+		return previous;
+	}
+	
+	void Tiering::promote(Frame * frame, Lambda * lambda) {
+		// Macros are evaluated in the scope of their caller, which is rarely hot:
+		if (lambda->is_macro()) {
+			lambda->set_promotable(false);
+			
+			return;
+		}
+		
+		if (lambda->tier() == INTERPRETED) {
+			if (!lambda->compiled())
+				lambda->set_compiled(Bytecode::Compiler::compile(frame, lambda->body(), true));
+			
+			if (_shared)
+				_shared->_promoted.push_back(lambda);
+		} else if (lambda->tier() == COMPILED && _native_compiler) {
+			NativeCode * native = _native_compiler(frame, lambda);
+			
+			if (native)
+				lambda->set_native(native);
+			else
+				lambda->set_promotable(false);
+		} else {
+			lambda->set_promotable(false);
+		}
+	}
+	
+	void Tiering::statistics(Frame * frame, std::ostream & buffer) {
+		// Include the time spent in the current tier so far:
+		switch_to(_current);
+		
+		buffer << "Tier Statistics" << std::endl;
+		
+		for (unsigned tier = INTERPRETED; tier < TIERS; tier += 1) {
+			buffer << "\t" << name((Tier)tier) << "\t\t" << _time[tier] << std::endl;
+		}
+		
+		buffer << "Promoted Lambdas" << std::endl;
+		
+		for (Lambda * lambda : _promoted) {
+			buffer << "\t" << Object::to_string(frame, lambda);
+			buffer << "\t\t" << name(lambda->tier());
+			buffer << "\t" << lambda->calls();
+			buffer << "\t" << lambda->iterations();
+			buffer << std::endl;
+		}
+	}
+	
+	Ref<Object> Tiering::statistics(Frame * frame) {
+		StringStreamT buffer;
+		
+		if (_shared)
+			_shared->statistics(frame, buffer);
+		
+		return new(frame) String(buffer.str());
+	}
+	
+	Ref<Object> Tiering::thresholds(Frame * frame) {
+		Integral * compiled = NULL, * native = NULL;
+		
+		frame->extract()[compiled][native];
+		
+		if (compiled) {
+			CountT value = compiled->to_integer().to_intermediate();
+			_thresholds[INTERPRETED] = value ? value : NEVER;
+		}
+		
+		if (native) {
+			CountT value = native->to_integer().to_intermediate();
+			_thresholds[COMPILED] = value ? value : NEVER;
+		}
+		
+		Cell * result = NULL, * last = NULL;
+		
+		for (unsigned tier = INTERPRETED; tier < NATIVE; tier += 1) {
+			CountT value = _thresholds[tier] == NEVER ? 0 : _thresholds[tier];
+			
+			last = Cell::append(frame, last, Integer::create(frame, value), result);
+		}
+		
+		return result;
+	}
+	
+	void Tiering::import(Frame * frame) {
+		_shared = new(frame) Tiering;
+		_since = Time();
+		
+		frame->update(frame->sym("tiering"), _shared);
+		
+		frame->update(frame->sym("tier-stats"), KAI_BUILTIN_FUNCTION(Tiering::statistics));
+		frame->update(frame->sym("tier-thresholds"), KAI_BUILTIN_FUNCTION(Tiering::thresholds));
+	}
+	
+}
@@ -0,0 +1,121 @@
+//
+//  Tiering.h
+//  This file is part of the "Kai" project, and is released under the MIT license.
+//
+//  Created by Samuel Williams on 19/10/26.
+//  Copyright (c) 2026 Samuel Williams. All rights reserved.
+//
+
+#ifndef _KAI_TIERING_H
+#define _KAI_TIERING_H
+
+#include "Object.hpp"
+
+#include <vector>
+
+namespace Kai {
+	
+	class Lambda;
+	
+	/// A lambda compiled to native code by an optional backend, such as the LLVM JIT.
+	class NativeCode : public Object {
+	public:
+		virtual ~NativeCode();
+		
+		/// Apply the native code to evaluated arguments. Returns false if the arguments or the result can't be represented natively, in which case the lambda is evaluated by a lower tier instead. Native code has no side effects, so it is safe to evaluate the lambda again.
+		virtual bool call(Frame * frame, Object ** arguments, std::size_t count, Ref<Object> & result) = 0;
+	};
+	
+	/** Lambdas count how many times they are called, and how many times they iterate by replacing themselves with a tail call. Once a lambda has been used often enough, it is promoted to the next tier: first to bytecode, and then to native code if a native compiler has been registered.
+	 
+	 Time is attributed to the tier of the innermost executing lambda, so the clock is only read when execution moves between tiers.
+	 */
+	class Tiering : public Object {
+	public:
+		enum Tier {
+			INTERPRETED = 0,
+			COMPILED = 1,
+			NATIVE = 2
+		};
+		
+		enum { TIERS = 3 };
+		
+		typedef std::size_t CountT;
+		
+		/// Returns native code for the lambda, or NULL if it can't be compiled.
+		typedef NativeCode * (*NativeCompilerT)(Frame * frame, Lambda * lambda);
+		
+		/// Attributes time to the given tier while it is in scope.
+		class Scope {
+		protected:
+			Tier _previous;
+			
+		public:
+			Scope(Tier tier) : _previous(Tiering::enter(tier)) {
+			}
+			
+			~Scope() {
+				Tiering::enter(_previous);
+			}
+		};
+		
+	protected:
+		static CountT _thresholds[TIERS];
+		static NativeCompilerT _native_compiler;
+		
+		static Tier _current;
+		static Time _since;
+		static Time _time[TIERS];
+		
+		/// The instance which records promoted lambdas, which is reachable from the global scope.
+		static Tiering * _shared;
+		
+		std::vector<Lambda *> _promoted;
+		
+		static Tier switch_to(Tier tier);
+		
+	public:
+		static const char * const NAME;
+		
+		Tiering();
+		virtual ~Tiering();
+		
+		virtual Ref<Symbol> identity(Frame * frame) const;
+		
+		virtual void mark(Memory::Traversal * traversal) const;
+		
+		static const char * name(Tier tier);
+		
+		/// The number of calls and iterations after which a lambda in the given tier is promoted.
+		static CountT threshold(Tier tier) { return _thresholds[tier]; }
+		
+		static void set_native_compiler(NativeCompilerT native_compiler) { _native_compiler = native_compiler; }
+		
+		static Tier current() { return _current; }
+		
+		/// Attribute time to the given tier from now on, and return the previous tier.
+		static Tier enter(Tier tier) {
+			if (tier == _current)
+				return tier;
+			
+			return switch_to(tier);
+		}
+		
+		/// Promote the lambda to the next tier, or prevent further promotion if that isn't possible.
+		static void promote(Frame * frame, Lambda * lambda);
+		
+		void statistics(Frame * frame, std::ostream & buffer);
+		
+		//% (tier-stats) -> string
+		static Ref<Object> statistics(Frame * frame);
+		
+		/// A threshold of zero disables promotion from that tier.
+		//% (tier-thresholds [compiled-threshold] [native-threshold]) -> (compiled-threshold native-threshold)
+		static Ref<Object> thresholds(Frame * frame);
+		
+		static void import(Frame * frame);
+	};
+	
+}
+
+#endif
@@ -22,7 +22,6 @@ end
 
 define_target "kai-library" do |target|
 	target.depends 'Language/C++14', private: true
-	target.depends "Library/llvm-engine"
 	
 	target.provides "Library/Kai" do
 		source_root = target.package.path + 'source'
@@ -31,6 +30,28 @@ define_target "kai-library" do |target|
 		
 		append linkflags library_path
 		append header_search_paths source_root
+		
+		# Primes are generated using a thread for each core:
+		append linkflags "-pthread"
+	end
+end
+
+define_target "kai-jit" do |target|
+	target.depends 'Language/C++17', private: true
+	
+	target.depends "Library/Kai"
+	target.depends "Library/llvm-engine"
+	
+	target.provides "Library/Kai-JIT" do
+		source_root = target.package.path + 'source'
+		
+		library_path = build static_library: "Kai-JIT", source_files: source_root.glob('Kai-lib/LLVM/**/*.{cpp,c}')
+		
+		append linkflags library_path
+		append header_search_paths source_root + 'Kai-lib'
+		
+		# The interpreter imports the compiler when this is defined:
+		append buildflags "-DKAI_JIT"
 	end
 end
 
@@ -61,6 +82,21 @@ define_target 'kai-executable' do |target|
 	end
 end
 
+define_target 'kai-jit-executable' do |target|
+	target.depends 'Library/Kai-JIT'
+	target.depends 'Library/Kai'
+	
+	target.depends 'Language/C++17'
+	
+	target.provides 'Executable/Kai-JIT' do
+		source_root = target.package.path + 'source/Kai-interpreter'
+		
+		executable_path = build executable: 'Kai-JIT', source_files: source_root.glob('main.cpp')
+		
+		kai_executable executable_path
+	end
+end
+
 define_target 'kai-run' do |target|
 	target.depends 'Executable/Kai'
 	
@@ -5,6 +5,8 @@
 #include <Kai/Memory/Collector.hpp>
 #include <Kai/Reference.hpp>
 
+#include <utility>
+
 namespace Kai
 {
 	namespace Memory
@@ -34,6 +36,34 @@ namespace Kai
 					examiner.check_equal(collector.collect(), 1);
 				}
 			},
+			
+			{"Reference Ownership",
+				[](UnitTest::Examiner & examiner) {
+					Memory::PageAllocation * allocator = Memory::PageAllocation::create(128 * Memory::page_size());
+					
+					Ref<ManagedObject> object = new(allocator) ManagedObject;
+					ManagedObject * pointer = object.get();
+					
+					{
+						Borrowed<ManagedObject> borrowed = object;
+						
+						examiner << "Borrowing an object doesn't retain it." << std::endl;
+						examiner.check_equal(pointer->reference_count(), 1);
+					}
+					
+					Ref<ManagedObject> moved = std::move(object);
+					
+					examiner << "Moving a reference transfers ownership without retaining the object." << std::endl;
+					examiner.check_equal(pointer->reference_count(), 1);
+					examiner.check(object.get() == NULL);
+					
+					object = std::move(moved);
+					
+					examiner << "Move assignment transfers ownership back." << std::endl;
+					examiner.check_equal(pointer->reference_count(), 1);
+					examiner.check(moved.get() == NULL);
+				}
+			},
 		};
 	}
 }